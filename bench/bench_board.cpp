@@ -0,0 +1,152 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/board.hpp"
+
+/* Measures the throughput of Board::update() over a grid of rules,
+ * radii, start densities and board sizes. Every configuration is
+ * printed as a line of CSV (or of JSON with --json), so that results
+ * of releases can be compared by scripts.
+ *
+ * Usage: bench_board [--quick] [--json] [--threads N] [--min-time SECONDS]
+ *   --quick      radii 1, 5 and 10 and the two smaller boards only
+ *   --json       one JSON object per line instead of CSV
+ *   --threads    threads of every board (1 by default)
+ *   --min-time   time spent measuring each configuration (0.2 s by default) */
+
+const int BENCH_WARMUP_GENERATIONS = 2;
+const int BENCH_GENERATIONS_MIN = 3;
+
+struct BenchOptions {
+    bool isQuick = false;
+    bool isJson = false;
+    int threads = 1;
+    double minSeconds = 0.2;
+};
+
+struct BenchResult {
+    int generations = 0;
+    double seconds = 0;
+};
+
+/* Returns random cells of the given dimensions in state 1
+ * with the given probability, and dead otherwise. */
+cells_t randomBenchCells(size_t height, size_t width, double density, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::bernoulli_distribution alive(density);
+    cells_t cells(height, width);
+    for (size_t row = 0; row < height; ++row)
+        for (size_t col = 0; col < width; ++col)
+            cells[row][col] = alive(generator) ? 1 : 0;
+    return cells;
+}
+
+/* Returns conditions of a rule for the neighborhood given by args,
+ * as fractions of its size in the spirit of Bosco's rule
+ * (R5,C2,M1,S34..58,B34..45,NM), so that boards of every radius
+ * keep evolving instead of dying out at once. */
+void setBenchConditions(BoardArgs &args) {
+    const int size = (int) getNeighborhoodSize(args);
+    args.birthConds.clear();
+    args.surviveConds.clear();
+    for (int count = size * 28 / 100; count <= size * 37 / 100; ++count)
+        args.birthConds.insert(count);
+    for (int count = size * 28 / 100; count <= size * 48 / 100; ++count)
+        args.surviveConds.insert(count);
+}
+
+/* Advances a board until at least minSeconds have passed and
+ * returns the count of measured generations with their time. */
+BenchResult measureUpdates(const BoardArgs &args, double density, double minSeconds) {
+    Board board(args, randomBenchCells(args.height, args.width, density, (unsigned) args.neighborhoodRadius));
+    for (int generation = 0; generation < BENCH_WARMUP_GENERATIONS; ++generation)
+        board.update();
+
+    BenchResult result;
+    const auto start = std::chrono::steady_clock::now();
+    while (result.generations < BENCH_GENERATIONS_MIN || result.seconds < minSeconds) {
+        board.update();
+        ++result.generations;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return result;
+}
+
+void printHeader(const BenchOptions &options) {
+    if (!options.isJson)
+        std::printf("neighborhood,radius,states,density,width,height,threads,generations,seconds,"
+                    "cells_per_second,ns_per_cell\n");
+}
+
+void printResult(const BenchOptions &options, const BoardArgs &args, double density, const BenchResult &result) {
+    const char *neighborhood = args.neighborhoodType == NeighborhoodType::MOORE ? "moore" : "von_neumann";
+    const double cells = (double) args.width * (double) args.height * result.generations;
+    const double cellsPerSecond = cells / result.seconds;
+    const double nsPerCell = 1e9 * result.seconds / cells;
+    if (options.isJson)
+        std::printf("{\"neighborhood\":\"%s\",\"radius\":%d,\"states\":%d,\"density\":%.2f,\"width\":%zu,"
+                    "\"height\":%zu,\"threads\":%d,\"generations\":%d,\"seconds\":%.6f,"
+                    "\"cells_per_second\":%.0f,\"ns_per_cell\":%.4f}\n",
+                    neighborhood, args.neighborhoodRadius, args.states, density, args.width, args.height,
+                    args.threads, result.generations, result.seconds, cellsPerSecond, nsPerCell);
+    else
+        std::printf("%s,%d,%d,%.2f,%zu,%zu,%d,%d,%.6f,%.0f,%.4f\n",
+                    neighborhood, args.neighborhoodRadius, args.states, density, args.width, args.height,
+                    args.threads, result.generations, result.seconds, cellsPerSecond, nsPerCell);
+    std::fflush(stdout);
+}
+
+BenchOptions parseOptions(int argc, char **argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0)
+            options.isQuick = true;
+        else if (std::strcmp(argv[i], "--json") == 0)
+            options.isJson = true;
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            options.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+            options.minSeconds = std::atof(argv[++i]);
+        else {
+            std::fprintf(stderr, "Usage: %s [--quick] [--json] [--threads N] [--min-time SECONDS]\n", argv[0]);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return options;
+}
+
+int main(int argc, char **argv) {
+    const BenchOptions options = parseOptions(argc, argv);
+
+    std::vector<int> radii;
+    for (int radius = 1; radius <= 10; ++radius)
+        if (!options.isQuick || radius == 1 || radius == 5 || radius == 10)
+            radii.push_back(radius);
+    const std::vector<size_t> sizes = options.isQuick ? std::vector<size_t>{256, 1024}
+                                                      : std::vector<size_t>{256, 1024, 4096};
+
+    printHeader(options);
+    for (size_t size : sizes) {
+        for (NeighborhoodType type : {NeighborhoodType::MOORE, NeighborhoodType::VON_NEUMANN}) {
+            for (int radius : radii) {
+                for (int states : {2, 48, 256}) {
+                    for (double density : {0.05, 0.3, 0.5}) {
+                        BoardArgs args;
+                        args.width = args.height = size;
+                        args.neighborhoodType = type;
+                        args.neighborhoodRadius = radius;
+                        args.states = states;
+                        args.threads = options.threads;
+                        setBenchConditions(args);
+                        printResult(options, args, density, measureUpdates(args, density, options.minSeconds));
+                    }
+                }
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -15,7 +15,7 @@ ext_modules = [
 setup(
     name="coremodule",
     version=__version__,
-    install_requires=['pybind11', 'pytest', 'pytest-cpp', 'setuptools_cpp',
+    install_requires=['pybind11', 'numpy', 'pytest', 'pytest-cpp', 'setuptools_cpp',
                       'pygame', 'tk', 'pygame-menu'],
     author="Lukasz Szarejko & Kuba Forczek",
     author_email="",
@@ -1,14 +1,83 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/complex.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+#include <cstring>
 #include "board.cpp"
+#include "counting.cpp"
+#include "bitslice.cpp"
 #include "random_rules.cpp"
+#include "simd.cpp"
+#include "thread_pool.cpp"
+#include "blocking.cpp"
+#include "sparse_board.cpp"
+#include "frame_ring.cpp"
+#include "incremental.cpp"
+#include "neighborhood.cpp"
+#include "render.cpp"
+#include "checkpoint.cpp"
+#include "rle.cpp"
 
 namespace py = pybind11;
 
+typedef std::vector<std::vector<cell_t>> nested_cells_t;
+typedef std::tuple<std::uint8_t, std::uint8_t, std::uint8_t> color_t;
+
+/* Converts a Python list of rows into a board cell container. */
+cells_t toCells(const nested_cells_t &rows) {
+    const size_t width = rows.empty() ? 0 : rows[0].size();
+    cells_t cells(rows.size(), width);
+    for (size_t row = 0; row < rows.size(); ++row) {
+        if (rows[row].size() != width)
+            throw std::invalid_argument("All rows of the start cell array must have the same length");
+        std::copy(rows[row].cbegin(), rows[row].cend(), cells[row]);
+    }
+    return cells;
+}
+
+/* Converts board cells into a list of rows for Python. */
+nested_cells_t toNestedCells(const cells_t &cells) {
+    nested_cells_t rows(cells.getHeight());
+    for (size_t row = 0; row < cells.getHeight(); ++row)
+        rows[row].assign(cells[row], cells[row] + cells.getWidth());
+    return rows;
+}
+
+/* Returns a read-only NumPy array over the memory of the cells,
+ * without copying them; 'owner' is kept alive by the array. */
+py::array_t<cell_t> toCellsView(const cells_t &cells, py::handle owner) {
+    py::array_t<cell_t> view({cells.getHeight(), cells.getWidth()},
+                             {cells.getStride() * sizeof(cell_t), sizeof(cell_t)},
+                             cells.data(), owner);
+    view.attr("flags").attr("writeable") = false;
+    return view;
+}
+
+/* Returns a new NumPy array with a copy of the cells. */
+py::array_t<cell_t> toCellsArray(const cells_t &cells) {
+    py::array_t<cell_t> array({cells.getHeight(), cells.getWidth()});
+    for (size_t row = 0; row < cells.getHeight(); ++row)
+        std::copy(cells[row], cells[row] + cells.getWidth(), array.mutable_data(row, 0));
+    return array;
+}
+
+/* Converts a Python (red, green, blue) tuple into a color. */
+Rgb toRgb(const color_t &color) {
+    return {std::get<0>(color), std::get<1>(color), std::get<2>(color)};
+}
+
 PYBIND11_MODULE(board, m) {
     m.doc() = "Plugin to simulate board logic in LtL game";
 
+    py::enum_<NeighborhoodType>(m, "NeighborhoodType")
+            .value("MOORE", NeighborhoodType::MOORE)
+            .value("VON_NEUMANN", NeighborhoodType::VON_NEUMANN)
+            .value("CIRCULAR", NeighborhoodType::CIRCULAR)
+            .value("CHECKERBOARD", NeighborhoodType::CHECKERBOARD)
+            .value("CROSS", NeighborhoodType::CROSS)
+            .value("HASH", NeighborhoodType::HASH)
+            .value("CUSTOM", NeighborhoodType::CUSTOM);
+
     py::class_<BoardArgs>(m, "BoardArgs")
             .def(py::init<>())
             .def_readwrite("neighborhoodRadius", &BoardArgs::neighborhoodRadius)
@@ -16,15 +85,211 @@ PYBIND11_MODULE(board, m) {
             .def_readwrite("surviveConds", &BoardArgs::surviveConds)
             .def_readwrite("birthConds", &BoardArgs::birthConds)
             .def_readwrite("isIncludeCenter", &BoardArgs::isIncludeCenter)
-            .def_readwrite("isMooreType", &BoardArgs::isMooreType);
+            .def_property("neighborhoodType", &getNeighborhoodType,
+                          [](BoardArgs &args, NeighborhoodType type) {
+                              args.neighborhoodType = type;
+                              args.isMooreType = true;
+                          })
+            .def_property("isMooreType",
+                          [](const BoardArgs &args) { return getNeighborhoodType(args) == NeighborhoodType::MOORE; },
+                          [](BoardArgs &args, bool isMoore) {
+                              args.neighborhoodType = isMoore ? NeighborhoodType::MOORE : NeighborhoodType::VON_NEUMANN;
+                              args.isMooreType = true;
+                          }, "Compatible view of neighborhoodType: true for Moore, false for von Neumann.")
+            .def_readwrite("neighborhoodWeights", &BoardArgs::neighborhoodWeights)
+            .def_readwrite("width", &BoardArgs::width)
+            .def_readwrite("height", &BoardArgs::height)
+            .def_readwrite("threads", &BoardArgs::threads)
+            .def_readwrite("isWrappedHorizontally", &BoardArgs::isWrappedHorizontally)
+            .def_readwrite("isWrappedVertically", &BoardArgs::isWrappedVertically);
+
+    py::class_<GenerationMetrics>(m, "GenerationMetrics")
+            .def_readonly("generations", &GenerationMetrics::generations)
+            .def_readonly("births", &GenerationMetrics::births)
+            .def_readonly("deaths", &GenerationMetrics::deaths)
+            .def_readonly("agings", &GenerationMetrics::agings)
+            .def_readonly("population", &GenerationMetrics::population)
+            .def_readonly("cellsSkipped", &GenerationMetrics::cellsSkipped)
+            .def_readonly("countSeconds", &GenerationMetrics::countSeconds)
+            .def_readonly("transitionSeconds", &GenerationMetrics::transitionSeconds)
+            .def_readonly("copySeconds", &GenerationMetrics::copySeconds)
+            .def_readonly("totalSeconds", &GenerationMetrics::totalSeconds);
+
+    py::class_<BoardStats>(m, "BoardStats")
+            .def_readonly("liveCount", &BoardStats::liveCount)
+            .def_readonly("histogram", &BoardStats::histogram)
+            .def_readonly("top", &BoardStats::top)
+            .def_readonly("left", &BoardStats::left)
+            .def_readonly("bottom", &BoardStats::bottom)
+            .def_readonly("right", &BoardStats::right)
+            .def_readonly("centroidRow", &BoardStats::centroidRow)
+            .def_readonly("centroidCol", &BoardStats::centroidCol);
+
+    py::enum_<Evolution>(m, "Evolution")
+            .value("RUNNING", Evolution::RUNNING)
+            .value("EXTINCT", Evolution::EXTINCT)
+            .value("STILL_LIFE", Evolution::STILL_LIFE)
+            .value("PERIODIC", Evolution::PERIODIC);
+
+    py::class_<CycleReport>(m, "CycleReport")
+            .def_readonly("evolution", &CycleReport::evolution)
+            .def_readonly("period", &CycleReport::period)
+            .def_readonly("generation", &CycleReport::generation);
 
     py::class_<Board>(m, "Board")
         .def(py::init<BoardArgs>(), py::arg("boardArgs"))
-        .def(py::init<BoardArgs, const cells_t &>(), py::arg("boardArgs"), py::arg("cells"))
-        .def("update", &Board::update, "Handles regular updates of the cell states, in accordance with game conditions.")
-        .def("getCells", &Board::getCells,"Returns const-reference to a 2-dimensional container with all cell values.")
-        .def("getSize", &Board::getSize, "Returns the size of the board.");
+        .def(py::init([](const BoardArgs &boardArgs, const nested_cells_t &cells) {
+            return Board(boardArgs, toCells(cells));
+        }), py::arg("boardArgs"), py::arg("cells"))
+        .def("update", &Board::update, py::call_guard<py::gil_scoped_release>(),
+             "Handles regular updates of the cell states, in accordance with game conditions.")
+        .def("step", &Board::step, py::arg("generations"), py::call_guard<py::gil_scoped_release>(),
+             "Advances the board by the given count of generations, as many calls to update() would.")
+        .def("getCells", [](const Board &board) {
+            return toNestedCells(board.getCells());
+        }, "Returns a list of rows with all cell values.")
+        .def("getCellsView", [](py::object self) {
+            const cells_t &shared = self.cast<Board &>().acquireSharedCells();
+            // the view holds the board and its shared cells until it is freed
+            py::capsule owner(new py::object(self), [](void *pointer) {
+                auto *board = static_cast<py::object *>(pointer);
+                board->cast<Board &>().releaseSharedCells();
+                delete board;
+            });
+            return toCellsView(shared, owner);
+        }, "Returns a read-only NumPy array of the cells without copying them. The array stays valid "
+           "and shows the current generation after every update; it must not be read while an update runs. "
+           "Updates copy the cells for views only while some of them are alive.")
+        .def("copyCells", [](const Board &board) {
+            return toCellsArray(board.getCells());
+        }, "Returns a NumPy array with a snapshot of the current cells.")
+        .def("recordChanges", &Board::recordChanges, py::arg("enabled"),
+             "Enables or disables recording of the cells changed by every update and step.")
+        .def("getChanges", [](const Board &board) {
+            const auto &changes = board.getChanges();
+            py::array_t<std::uint32_t> array({changes.size(), (size_t) 3});
+            if (!changes.empty())
+                std::memcpy(array.mutable_data(), changes.data(), changes.size() * sizeof(CellChange));
+            return array;
+        }, "Returns a NumPy array with a row (row, column, new state) for every cell changed "
+           "by the last update or step, in row-major order.")
+        .def("recordMetrics", &Board::recordMetrics, py::arg("enabled"),
+             "Enables or disables recording of metrics of every update and step.")
+        .def("getMetrics", &Board::getMetrics,
+             "Returns a copy of the metrics of the last update or step; all zero if recording is disabled.")
+        .def("recordStats", &Board::recordStats, py::arg("enabled"),
+             "Enables or disables statistics of the cells, kept up to date by every update and step.")
+        .def("getStats", &Board::getStats,
+             "Returns a copy of the statistics of the current generation: count of live cells, histogram "
+             "of states, bounding box [top, bottom) x [left, right) and centroid of live cells.")
+        .def("trackCycles", &Board::trackCycles, py::arg("enabled"),
+             "Enables or disables finding of extinct, still and periodic boards by hashes of every generation.")
+        .def("getCycleReport", &Board::getCycleReport,
+             "Returns a copy of the behavior found since tracking was enabled, with its period "
+             "and the generation at which it was found.")
+        .def("getGeneration", &Board::getGeneration,
+             "Returns the count of generations advanced since the board was created.")
+        .def("getArgs", &Board::getArgs, "Returns a copy of the arguments the board was created with.")
+        .def("getSize", &Board::getSize, "Returns the size of the board.")
+        .def("getWidth", &Board::getWidth, "Returns the count of columns of the board.")
+        .def("getHeight", &Board::getHeight, "Returns the count of rows of the board.")
+        .def("getTileCount", &Board::getTileCount, "Returns the count of tiles the board is divided into for tracking changes.")
+        .def("getActiveTileCount", &Board::getActiveTileCount, "Returns the count of tiles recomputed by the last update.");
+
+    py::class_<FrameRing>(m, "FrameRing")
+        .def(py::init<const std::string &, size_t, size_t, size_t>(),
+             py::arg("name"), py::arg("height"), py::arg("width"), py::arg("slots") = FRAME_SLOTS,
+             "Creates a ring of frames in shared memory under the given name, removed with the ring.")
+        .def(py::init<const std::string &>(), py::arg("name"),
+             "Opens a ring created under the given name by another process.")
+        .def("publish", [](FrameRing &ring, const Board &board) {
+            return ring.publish(board.getCells());
+        }, py::arg("board"), py::call_guard<py::gil_scoped_release>(),
+             "Writes the cells of the board as the next frame and returns its number.")
+        .def("read", [](const FrameRing &ring) -> py::object {
+            cells_t frame;
+            const std::uint64_t number = ring.readLatest(frame);
+            if (number == 0)
+                return py::none();
+            return py::make_tuple(number, toCellsArray(frame));
+        }, "Returns (number, cells) of the latest frame, or None if nothing has been published yet.")
+        .def("getLatestSequence", &FrameRing::getLatestSequence,
+             "Returns the number of the latest frame, 0 if there is none.")
+        .def("getHeight", &FrameRing::getHeight, "Returns the count of rows of a frame.")
+        .def("getWidth", &FrameRing::getWidth, "Returns the count of columns of a frame.");
+
+    py::class_<Renderer>(m, "Renderer")
+        .def(py::init([](int states, size_t tileSize, size_t gap,
+                         const color_t &deadColor, const color_t &aliveColor, const color_t &gapColor) {
+            return Renderer(states, tileSize, gap, toRgb(deadColor), toRgb(aliveColor), toRgb(gapColor));
+        }), py::arg("states"), py::arg("tileSize"), py::arg("gap"),
+             py::arg("deadColor"), py::arg("aliveColor"), py::arg("gapColor"),
+             "Creates a renderer drawing cells as tiles of the given size, with gaps on each side.")
+        .def("render", [](const Renderer &renderer, py::array_t<cell_t, py::array::c_style | py::array::forcecast> cells) {
+            if (cells.ndim() != 2)
+                throw std::invalid_argument("Cells have to be a 2-dimensional array");
+            const size_t height = (size_t) cells.shape(0), width = (size_t) cells.shape(1);
+            const size_t tileSize = renderer.getTileSize();
+            py::array_t<std::uint8_t> frame({height * tileSize, width * tileSize, (size_t) 3});
+            const cell_t *source = cells.data();
+            std::uint8_t *target = frame.mutable_data();
+            {
+                py::gil_scoped_release release;
+                renderer.render(source, height, width, width, target);
+            }
+            return frame;
+        }, py::arg("cells"),
+             "Returns an RGB array of the cells drawn as tiles, indexed by pixel row of the cells, "
+             "pixel column and color channel, ready for pygame.surfarray.")
+        .def("getTileSize", &Renderer::getTileSize, "Returns the count of pixels on a side of a tile.");
+
+    py::class_<SparseBoard>(m, "SparseBoard")
+        .def(py::init<BoardArgs>(), py::arg("boardArgs"))
+        .def("update", &SparseBoard::update, py::call_guard<py::gil_scoped_release>(),
+             "Advances the board by a single generation.")
+        .def("step", &SparseBoard::step, py::arg("generations"), py::call_guard<py::gil_scoped_release>(),
+             "Advances the board by the given count of generations.")
+        .def("getCell", &SparseBoard::getCell, py::arg("row"), py::arg("col"),
+             "Returns the state of the cell at the given position.")
+        .def("setCell", &SparseBoard::setCell, py::arg("row"), py::arg("col"), py::arg("state"),
+             "Sets the state of the cell at the given position.")
+        .def("setCells", [](SparseBoard &board, coord_t top, coord_t left, const nested_cells_t &cells) {
+            board.setCells(top, left, toCells(cells));
+        }, py::arg("top"), py::arg("left"), py::arg("cells"),
+             "Copies a list of rows onto the board, starting at the given position.")
+        .def("getRegion", [](const SparseBoard &board, coord_t top, coord_t left, size_t height, size_t width) {
+            return toNestedCells(board.getRegion(top, left, height, width));
+        }, py::arg("top"), py::arg("left"), py::arg("height"), py::arg("width"),
+             "Returns a list of rows with cell values of the given rectangle.")
+        .def("getBoundingBox", [](const SparseBoard &board) -> py::object {
+            if (board.getPopulation() == 0)
+                return py::none();
+            const BoundingBox box = board.getBoundingBox();
+            return py::make_tuple(box.top, box.left, box.bottom, box.right);
+        }, "Returns (top, left, bottom, right) of the smallest rectangle holding all non-dead cells, "
+           "with bottom and right exclusive, or None for an empty board.")
+        .def("getPopulation", &SparseBoard::getPopulation, "Returns the count of non-dead cells.")
+        .def("getChunkCount", &SparseBoard::getChunkCount, "Returns the count of chunks currently allocated.");
 
+    m.def("saveCheckpoint", &saveCheckpoint, py::arg("board"), py::arg("path"),
+          py::call_guard<py::gil_scoped_release>(),
+          "Writes the rules, generation and run-length compressed cells of the board to a binary file.");
+    m.def("loadCheckpoint", &loadCheckpoint, py::arg("path"), py::call_guard<py::gil_scoped_release>(),
+          "Restores a board from a file written by saveCheckpoint, mapped into memory.");
+    m.def("getGollyRule", &getGollyRule, py::arg("boardArgs"),
+          "Returns the rules and size of the board arguments in the Larger than Life syntax of Golly.");
+    m.def("parseGollyRule", [](const std::string &rule) {
+        BoardArgs boardArgs;
+        parseGollyRule(rule, boardArgs);
+        return boardArgs;
+    }, py::arg("rule"), "Returns board arguments with the rules, and bounded grid if any, of a Golly rule.");
+    m.def("writeRle", [](const Board &board) {
+        return writeRle(board.getArgs(), board.getCells());
+    }, py::arg("board"), "Returns the cells and rules of the board in the RLE format of Golly.");
+    m.def("loadRle", [](const std::string &text) {
+        RlePattern pattern = readRle(text);
+        return Board(std::move(pattern.args), std::move(pattern.cells), 0);
+    }, py::arg("text"), "Creates a board from a pattern in the RLE format of Golly.");
 }
 
 PYBIND11_MODULE(myrandoms, m){
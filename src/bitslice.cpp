@@ -0,0 +1,305 @@
+#include "bitslice.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+
+/* ---------- Bit-sliced arithmetic ---------- */
+
+/* Returns the count of bits needed to write the value. */
+constexpr int getBitWidth(count_t value) {
+    int bits = 0;
+    for (; value != 0; value >>= 1) ++bits;
+    return bits;
+}
+
+/* Returns the lanes of cells shifted by 'offset' columns, so that
+ * lane b holds the cell in column b+offset (-64 < offset < 64). */
+inline mask_word_t getShifted(const mask_word_t *row, long word, int offset) {
+    if (offset > 0)
+        return (row[word] >> offset) | (row[word + 1] << (MASK_WORD_BITS - offset));
+    if (offset < 0)
+        return (row[word] << -offset) | (row[word - 1] >> (MASK_WORD_BITS + offset));
+    return row[word];
+}
+
+/* Returns the count of bit planes holding neighborhood counts,
+ * center included, for the radius and the neighborhood type. */
+constexpr int getCountPlanes(int radius, bool isMooreType) {
+    return getBitWidth(isMooreType ?
+                       (count_t) ((2 * radius + 1) * (2 * radius + 1)) :
+                       (count_t) (2 * radius * (radius + 1) + 1));
+}
+
+/* Returns the count of bit planes holding a count of 2r+1 cells. */
+constexpr int getEdgePlanes(int radius) {
+    return getBitWidth((count_t) (2 * radius + 1));
+}
+
+/* Adds a single bit to the count of every lane. */
+template<int PlaneCount>
+inline void addBit(mask_word_t *planes, mask_word_t bit) {
+    for (int plane = 0; plane < PlaneCount && bit != 0; ++plane) {
+        const mask_word_t value = planes[plane];
+        planes[plane] = value ^ bit;
+        bit &= value;
+    }
+}
+
+/* Adds counts of TermPlanes planes to counts of SumPlanes planes. */
+template<int SumPlanes, int TermPlanes>
+inline void addPlanes(mask_word_t *sum, const mask_word_t *term) {
+    mask_word_t carry = 0;
+    int plane = 0;
+    for (; plane < TermPlanes; ++plane) {
+        const mask_word_t value = sum[plane];
+        const mask_word_t half = value ^ term[plane];
+        sum[plane] = half ^ carry;
+        carry = (value & term[plane]) | (half & carry);
+    }
+    for (; plane < SumPlanes && carry != 0; ++plane) {
+        const mask_word_t value = sum[plane];
+        sum[plane] = value ^ carry;
+        carry &= value;
+    }
+}
+
+/* Subtracts counts of TermPlanes planes from counts of SumPlanes
+ * planes. Every result has to be non-negative. */
+template<int SumPlanes, int TermPlanes>
+inline void subtractPlanes(mask_word_t *sum, const mask_word_t *term) {
+    mask_word_t borrow = 0;
+    int plane = 0;
+    for (; plane < TermPlanes; ++plane) {
+        const mask_word_t value = sum[plane];
+        const mask_word_t half = value ^ term[plane];
+        sum[plane] = half ^ borrow;
+        borrow = (~value & term[plane]) | (~half & borrow);
+    }
+    for (; plane < SumPlanes && borrow != 0; ++plane) {
+        const mask_word_t value = sum[plane];
+        sum[plane] = value ^ borrow;
+        borrow &= ~value;
+    }
+}
+
+/* Returns lanes whose count is greater than 'limit' (and, if
+ * 'orEqual' is set, lanes with a count equal to it too). */
+template<int PlaneCount>
+inline mask_word_t compareWith(const mask_word_t *planes, count_t limit, bool orEqual) {
+    if ((limit >> PlaneCount) != 0)
+        return 0; // limit not reachable with this many planes
+
+    mask_word_t greater = 0, equal = ~(mask_word_t) 0;
+    for (int plane = PlaneCount - 1; plane >= 0; --plane) {
+        if ((limit >> plane) & 1) {
+            equal &= planes[plane];
+        } else {
+            greater |= equal & planes[plane];
+            equal &= ~planes[plane];
+        }
+    }
+    return orEqual ? (greater | equal) : greater;
+}
+
+/* Joins sorted counts into ranges of consecutive values,
+ * moving each count by 'shift'. */
+std::vector<std::pair<count_t, count_t>> getRanges(const conds_t &conds, count_t maxCount, count_t shift) {
+    std::vector<std::pair<count_t, count_t>> ranges;
+    for (int count : conds) {
+        if (count < 0 || (count_t) count > maxCount)
+            continue; // condition can never be met
+        const count_t value = (count_t) count + shift;
+        if (!ranges.empty() && ranges.back().second + 1 == value)
+            ranges.back().second = value;
+        else
+            ranges.emplace_back(value, value);
+    }
+    return ranges;
+}
+
+/* ------------------------------------------- */
+
+BitSliceStepper::BitSliceStepper(const BoardArgs &boardArgs, ThreadPool *threadPool)
+        : radius(boardArgs.neighborhoodRadius),
+          pool(threadPool),
+          stepRows(getStepRows(boardArgs)) {
+    // Counts include the center cell, which is alive only for
+    // cells tested for survival
+    const count_t maxNeighbors = getNeighborhoodSize(boardArgs);
+    birthRanges = getRanges(boardArgs.birthConds, maxNeighbors, 0);
+    survivalRanges = getRanges(boardArgs.surviveConds, maxNeighbors, boardArgs.isIncludeCenter ? 0 : 1);
+}
+
+bool BitSliceStepper::isSupported(const BoardArgs &boardArgs) {
+    return boardArgs.states == 2 && boardArgs.neighborhoodRadius <= BITSLICE_RADIUS_MAX
+           && (getNeighborhoodType(boardArgs) == NeighborhoodType::MOORE
+               || getNeighborhoodType(boardArgs) == NeighborhoodType::VON_NEUMANN);
+}
+
+void BitSliceStepper::step(const mask_t &alive, mask_t &nextAlive, size_t width, StatsDelta *deltas) {
+    copyPadded(alive);
+    bandBuffers.resize(getBandCount(pool, alive.getHeight()));
+    forEachBand(pool, alive.getHeight(), [&](size_t band, size_t first, size_t last) {
+        (this->*stepRows)(nextAlive, width, (long) first, (long) last, bandBuffers[band],
+                          deltas ? &deltas[band] : nullptr);
+    });
+}
+
+void BitSliceStepper::copyPadded(const mask_t &alive) {
+    const size_t margin = 2 * (size_t) radius + 1;
+    if (padded.getHeight() != alive.getHeight() + 2 * margin || padded.getWidth() != alive.getWidth() + 2)
+        padded = mask_t(alive.getHeight() + 2 * margin, alive.getWidth() + 2);
+
+    forEachBand(pool, alive.getHeight(), [&](size_t, size_t first, size_t last) {
+        for (size_t row = first; row < last; ++row)
+            std::copy(alive[row], alive[row] + alive.getWidth(), padded[row + margin] + 1);
+    });
+}
+
+const mask_word_t *BitSliceStepper::getPaddedRow(long row) const {
+    return padded[(size_t) (row + 2 * radius + 1)] + 1;
+}
+
+template<bool IsMooreType, int... Radii>
+constexpr std::array<BitSliceStepper::step_rows_t, sizeof...(Radii)>
+BitSliceStepper::makeStepTable(std::integer_sequence<int, Radii...>) {
+    if constexpr (IsMooreType)
+        return {&BitSliceStepper::stepMoore<Radii + 1>...};
+    else
+        return {&BitSliceStepper::stepVonNeumann<Radii + 1>...};
+}
+
+BitSliceStepper::step_rows_t BitSliceStepper::getStepRows(const BoardArgs &boardArgs) {
+    static const auto mooreTable = makeStepTable<true>(std::make_integer_sequence<int, BITSLICE_RADIUS_MAX>());
+    static const auto vonNeumannTable = makeStepTable<false>(std::make_integer_sequence<int, BITSLICE_RADIUS_MAX>());
+    if (boardArgs.neighborhoodRadius < 1 || boardArgs.neighborhoodRadius > BITSLICE_RADIUS_MAX)
+        throw std::invalid_argument("Neighborhood radius out of range for bit-sliced rules");
+
+    const size_t index = (size_t) boardArgs.neighborhoodRadius - 1;
+    return getNeighborhoodType(boardArgs) == NeighborhoodType::MOORE ? mooreTable[index] : vonNeumannTable[index];
+}
+
+template<int CountPlanes>
+mask_word_t BitSliceStepper::applyRules(const mask_word_t *planes, mask_word_t alive) const {
+    mask_word_t born = 0, survived = 0;
+    for (const auto &range : birthRanges)
+        born |= compareWith<CountPlanes>(planes, range.first, true)
+                & ~compareWith<CountPlanes>(planes, range.second, false);
+    for (const auto &range : survivalRanges)
+        survived |= compareWith<CountPlanes>(planes, range.first, true)
+                    & ~compareWith<CountPlanes>(planes, range.second, false);
+    return (~alive & born) | (alive & survived);
+}
+
+template<int Radius>
+void BitSliceStepper::stepMoore(mask_t &nextAlive, size_t width, long first, long last,
+                                BandBuffers &buffers, StatsDelta *delta) const {
+    constexpr int countPlanes = getCountPlanes(Radius, true);
+    constexpr int edgePlanes = getEdgePlanes(Radius);
+    const long height = (long) nextAlive.getHeight();
+    const long words = (long) nextAlive.getWidth();
+    const long ringSize = 2 * Radius + 2;
+    const size_t rowCountSize = (size_t) (words * edgePlanes);
+    const mask_word_t lastWordMask = ~(mask_word_t) 0 >> ((MASK_WORD_BITS - width % MASK_WORD_BITS) % MASK_WORD_BITS);
+
+    std::vector<mask_word_t> &counts = buffers.counts;
+    std::vector<mask_word_t> &rowCounts = buffers.rowCounts;
+    counts.assign((size_t) (words * countPlanes), 0);
+    rowCounts.resize(rowCountSize * (size_t) ringSize);
+
+    // The window of rows moves down one row per step: the row
+    // entering it is counted horizontally and added, the row
+    // leaving it is subtracted. Rows outside of the board
+    // are skipped, as they hold no cells.
+    const long start = first - Radius;
+    const long firstCounted = std::max(start, 0L);
+    for (long entering = start; entering < last + Radius; ++entering) {
+        const long leaving = entering - 2 * Radius - 1;
+        const long center = entering - Radius;
+        mask_word_t *enteringCounts = &rowCounts[(size_t) ((entering - start) % ringSize) * rowCountSize];
+        const mask_word_t *leavingCounts = &rowCounts[(size_t) ((leaving - start + ringSize) % ringSize) * rowCountSize];
+        const mask_word_t *row = getPaddedRow(entering);
+
+        for (long word = 0; word < words; ++word) {
+            mask_word_t *wordCounts = &counts[(size_t) (word * countPlanes)];
+            if (leaving >= firstCounted)
+                subtractPlanes<countPlanes, edgePlanes>(wordCounts, &leavingCounts[word * edgePlanes]);
+
+            if (entering >= 0 && entering < height) {
+                mask_word_t *horizontal = &enteringCounts[word * edgePlanes];
+                std::fill(horizontal, horizontal + edgePlanes, 0);
+                for (int offset = -Radius; offset <= Radius; ++offset)
+                    addBit<edgePlanes>(horizontal, getShifted(row, word, offset));
+                addPlanes<countPlanes, edgePlanes>(wordCounts, horizontal);
+            }
+
+            if (center >= first) {
+                const mask_word_t current = getPaddedRow(center)[word];
+                mask_word_t next = applyRules<countPlanes>(wordCounts, current);
+                next = (word == words - 1 ? next & lastWordMask : next);
+                nextAlive[(size_t) center][word] = next;
+                if (delta)
+                    addWordDelta(current, next, (size_t) center, (size_t) word, *delta);
+            }
+        }
+    }
+}
+
+template<int Radius>
+void BitSliceStepper::stepVonNeumann(mask_t &nextAlive, size_t width, long first, long last,
+                                     BandBuffers &buffers, StatsDelta *delta) const {
+    constexpr int countPlanes = getCountPlanes(Radius, false);
+    constexpr int edgePlanes = getEdgePlanes(Radius);
+    const long words = (long) nextAlive.getWidth();
+    const mask_word_t lastWordMask = ~(mask_word_t) 0 >> ((MASK_WORD_BITS - width % MASK_WORD_BITS) % MASK_WORD_BITS);
+
+    // Counts start from the whole diamond centered above the band
+    std::vector<mask_word_t> &counts = buffers.counts;
+    counts.assign((size_t) (words * countPlanes), 0);
+    for (long word = 0; word < words; ++word)
+        addDiamond<Radius, countPlanes>(&counts[(size_t) (word * countPlanes)], first - 1, word);
+
+    // The diamond moves down one row per step: it loses its
+    // top edge (a V-shape of 2r+1 cells) and gains a bottom edge.
+    for (long center = first; center < last; ++center) {
+        for (long word = 0; word < words; ++word) {
+            mask_word_t *wordCounts = &counts[(size_t) (word * countPlanes)];
+            mask_word_t edge[edgePlanes] = {};
+
+            // top edge of the diamond centered one row above
+            for (int k = 0; k <= Radius; ++k) {
+                const mask_word_t *row = getPaddedRow(center - 1 - Radius + k);
+                addBit<edgePlanes>(edge, getShifted(row, word, -k));
+                if (k != 0) addBit<edgePlanes>(edge, getShifted(row, word, k));
+            }
+            subtractPlanes<countPlanes, edgePlanes>(wordCounts, edge);
+
+            // bottom edge of the current diamond
+            std::fill(edge, edge + edgePlanes, 0);
+            for (int k = 0; k <= Radius; ++k) {
+                const mask_word_t *row = getPaddedRow(center + Radius - k);
+                addBit<edgePlanes>(edge, getShifted(row, word, -k));
+                if (k != 0) addBit<edgePlanes>(edge, getShifted(row, word, k));
+            }
+            addPlanes<countPlanes, edgePlanes>(wordCounts, edge);
+
+            const mask_word_t current = getPaddedRow(center)[word];
+            mask_word_t next = applyRules<countPlanes>(wordCounts, current);
+            next = (word == words - 1 ? next & lastWordMask : next);
+            nextAlive[(size_t) center][word] = next;
+            if (delta)
+                addWordDelta(current, next, (size_t) center, (size_t) word, *delta);
+        }
+    }
+}
+
+template<int Radius, int CountPlanes>
+void BitSliceStepper::addDiamond(mask_word_t *planes, long center, long word) const {
+    for (int offset = -Radius; offset <= Radius; ++offset) {
+        const mask_word_t *row = getPaddedRow(center + offset);
+        const int reach = Radius - std::abs(offset);
+        for (int k = -reach; k <= reach; ++k)
+            addBit<CountPlanes>(planes, getShifted(row, word, k));
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include "board.hpp"
+#include "thread_pool.hpp"
+
+const int BITSLICE_RADIUS_MAX = 10;
+
+/* Advances two-state rules 64 cells at a time. Every word of the
+ * alive mask is treated as 64 independent lanes: neighbor counts
+ * are kept bit-sliced (plane p holds bit p of the count of every
+ * lane), summed with bitwise adders and tested against birth and
+ * survival conditions with bitwise comparators. Bands of rows
+ * are advanced independently, each by a thread of the pool. */
+class BitSliceStepper {
+
+    typedef std::pair<count_t, count_t> range_t;
+
+    const int radius;
+
+    /* Neighbor counts, including the center cell, giving birth
+     * to a dead cell or keeping a fully alive cell alive. */
+    std::vector<range_t> birthRanges;
+    std::vector<range_t> survivalRanges;
+
+    /* Copy of the alive mask surrounded by 2r+1 zero rows and
+     * a zero word on both sides of each row. */
+    mask_t padded;
+
+    /* Working memory of a single band of rows. */
+    struct BandBuffers {
+        std::vector<mask_word_t> counts;    // sliding counts of every word of a row
+        std::vector<mask_word_t> rowCounts; // ring of horizontal counts of 2r+2 rows
+    };
+
+    ThreadPool *pool;
+    std::vector<BandBuffers> bandBuffers;
+
+    /* Writes rows [first, last) of the next alive mask. */
+    typedef void (BitSliceStepper::*step_rows_t)(mask_t &nextAlive, size_t width, long first, long last,
+                                                 BandBuffers &buffers, StatsDelta *delta) const;
+
+    /* Variant of stepMoore() or stepVonNeumann() compiled for the
+     * radius and the neighborhood type, picked once at creation. */
+    step_rows_t stepRows;
+
+public:
+
+    /* Bands of rows are advanced by the threads of 'threadPool',
+     * or by the calling thread only, if it is null. */
+    explicit BitSliceStepper(const BoardArgs &boardArgs, ThreadPool *threadPool = nullptr);
+
+    /* Returns true if rules given by boardArgs
+     * can be advanced by this engine. */
+    static bool isSupported(const BoardArgs &boardArgs);
+
+    /* Writes the alive mask of the next generation of a board
+     * 'width' cells wide. Changes of the rows of every band are
+     * added to its element of 'deltas', unless it is null. */
+    void step(const mask_t &alive, mask_t &nextAlive, size_t width, StatsDelta *deltas = nullptr);
+
+private:
+
+    /* Copies the alive mask into the padded buffer. */
+    void copyPadded(const mask_t &alive);
+
+    /* Returns a row of the padded mask; rows from -(2r+1) to
+     * height+2r and words from -1 to the row length are valid. */
+    const mask_word_t *getPaddedRow(long row) const;
+
+    /* Returns the variant of stepMoore() or stepVonNeumann()
+     * matching the radius and the neighborhood type. */
+    static step_rows_t getStepRows(const BoardArgs &boardArgs);
+
+    /* Builds the table of variants for radii 1, 2, ... */
+    template<bool IsMooreType, int... Radii>
+    static constexpr std::array<step_rows_t, sizeof...(Radii)> makeStepTable(std::integer_sequence<int, Radii...>);
+
+    /* Write rows [first, last) of the next alive mask, adding
+     * changed words to 'delta', unless it is null. Loops over
+     * the neighborhood and over the bit planes of counts have fixed
+     * bounds in every variant, so they are unrolled by the compiler. */
+    template<int Radius>
+    void stepMoore(mask_t &nextAlive, size_t width, long first, long last, BandBuffers &buffers,
+                   StatsDelta *delta) const;
+
+    template<int Radius>
+    void stepVonNeumann(mask_t &nextAlive, size_t width, long first, long last, BandBuffers &buffers,
+                        StatsDelta *delta) const;
+
+    /* Adds the count of the whole diamond centered in the given
+     * row to the bit-sliced counts of a word. */
+    template<int Radius, int CountPlanes>
+    void addDiamond(mask_word_t *planes, long center, long word) const;
+
+    /* Returns lanes alive in the next generation, given the
+     * bit-sliced counts and the lanes alive currently. */
+    template<int CountPlanes>
+    mask_word_t applyRules(const mask_word_t *planes, mask_word_t alive) const;
+};
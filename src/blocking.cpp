@@ -0,0 +1,102 @@
+#include "blocking.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <utility>
+
+/* Copies rows [firstRow, lastRow) and columns [firstCol, lastCol)
+ * of a grid into 'target', which is resized to hold them, if needed. */
+template<typename T>
+void copyRegion(const Grid<T> &source, Grid<T> &target, size_t firstRow, size_t lastRow,
+                size_t firstCol, size_t lastCol) {
+    if (target.getHeight() != lastRow - firstRow || target.getWidth() != lastCol - firstCol)
+        target = Grid<T>(lastRow - firstRow, lastCol - firstCol);
+    for (size_t row = firstRow; row < lastRow; ++row)
+        std::copy(source[row] + firstCol, source[row] + lastCol, target[row - firstRow]);
+}
+
+/* Copies a copied region back into rows [firstRow, lastRow) and
+ * columns [firstCol, lastCol) of 'target'; the region starts at
+ * row 'top' and column 'left' of 'target'. */
+template<typename T>
+void writeRegion(const Grid<T> &region, Grid<T> &target, size_t top, size_t left,
+                 size_t firstRow, size_t lastRow, size_t firstCol, size_t lastCol) {
+    for (size_t row = firstRow; row < lastRow; ++row)
+        std::copy(region[row - top] + (firstCol - left), region[row - top] + (lastCol - left), target[row] + firstCol);
+}
+
+
+TemporalBlocker::TemporalBlocker(const BoardArgs &boardArgs, ThreadPool *threadPool)
+        : args(boardArgs),
+          isBitSliced(BitSliceStepper::isSupported(boardArgs)),
+          rules(boardArgs),
+          kernels(getRowKernels()),
+          pool(threadPool),
+          tileBuffers(threadPool ? threadPool->getThreadCount() : 1) {}
+
+void TemporalBlocker::stepRegion(size_t band, const cells_t &cells, const mask_t &alive,
+                                 cells_t &nextCells, mask_t &nextAlive, size_t width,
+                                 size_t first, size_t last, size_t firstWord, size_t lastWord,
+                                 size_t depth, StatsDelta *delta) {
+    TileBuffers &buffers = tileBuffers[band];
+    const size_t height = alive.getHeight();
+    const size_t words = alive.getWidth();
+    const size_t ghostRows = depth * (size_t) args.neighborhoodRadius;
+    const size_t top = (first < ghostRows ? 0 : first - ghostRows);
+    const size_t bottom = std::min(last + ghostRows, height);
+
+    // ghost columns are whole mask words
+    const size_t ghostWords = (ghostRows + MASK_WORD_BITS - 1) / MASK_WORD_BITS;
+    const size_t left = (firstWord < ghostWords ? 0 : firstWord - ghostWords);
+    const size_t right = std::min(lastWord + ghostWords, words);
+    const size_t leftCol = left * MASK_WORD_BITS;
+    const size_t regionWidth = std::min(right * MASK_WORD_BITS, width) - leftCol;
+
+    copyRegion(alive, buffers.alive, top, bottom, left, right);
+    if (buffers.nextAlive.getHeight() != buffers.alive.getHeight() || buffers.nextAlive.getWidth() != buffers.alive.getWidth())
+        buffers.nextAlive = mask_t(buffers.alive.getHeight(), buffers.alive.getWidth());
+
+    if (isBitSliced) {
+        if (!buffers.bitSlicer)
+            buffers.bitSlicer = std::make_unique<BitSliceStepper>(args);
+    } else {
+        if (!buffers.counter)
+            buffers.counter = makeNeighborCounter(args);
+        copyRegion(cells, buffers.cells, top, bottom, leftCol, leftCol + regionWidth);
+        if (buffers.nextCells.getHeight() != buffers.cells.getHeight() || buffers.nextCells.getWidth() != regionWidth)
+            buffers.nextCells = cells_t(buffers.cells.getHeight(), regionWidth);
+        buffers.neighbors.resize(regionWidth);
+    }
+
+    for (size_t generation = 0; generation < depth; ++generation)
+        advanceTile(buffers, regionWidth);
+
+    const size_t firstCol = firstWord * MASK_WORD_BITS;
+    const size_t lastCol = std::min(lastWord * MASK_WORD_BITS, width);
+    writeRegion(buffers.alive, nextAlive, top, left, first, last, firstWord, lastWord);
+    if (!isBitSliced)
+        writeRegion(buffers.cells, nextCells, top, leftCol, first, last, firstCol, lastCol);
+    if (!delta) return;
+
+    // the written rows of the tile are still in the cache
+    for (size_t row = first; row < last; ++row) {
+        if (isBitSliced) {
+            for (size_t word = firstWord; word < lastWord; ++word)
+                addWordDelta(alive[row][word], buffers.alive[row - top][word - left], row, word, *delta);
+            continue;
+        }
+        addCellsDelta(cells[row] + firstCol, buffers.cells[row - top] + (firstCol - leftCol),
+                      row, firstCol, lastCol - firstCol, *delta);
+    }
+}
+
+void TemporalBlocker::advanceTile(TileBuffers &buffers, size_t width) const {
+    if (isBitSliced) {
+        buffers.bitSlicer->step(buffers.alive, buffers.nextAlive, width);
+    } else {
+        buffers.counter->prepare(buffers.alive, width);
+        advanceRows(*buffers.counter, kernels, rules.getView(), buffers.cells, buffers.nextCells,
+                    buffers.nextAlive, 0, buffers.cells.getHeight(), buffers.neighbors.data());
+        std::swap(buffers.cells, buffers.nextCells);
+    }
+    std::swap(buffers.alive, buffers.nextAlive);
+}
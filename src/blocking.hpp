@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "board.hpp"
+#include "counting.hpp"
+#include "bitslice.hpp"
+#include "thread_pool.hpp"
+
+/* Advances regions of a board several generations on their own
+ * (temporal blocking). A region of full mask words is copied
+ * together with d*r ghost rows on both sides (and ghost columns,
+ * rounded up to whole mask words), advanced d generations while
+ * it stays in the cache, and its inner cells are written to the
+ * next buffers. Ghost cells go stale by r cells per generation,
+ * so after d generations the inner ones are still exact. Edges of
+ * the board are never padded, so cells outside of it stay dead.
+ * Boards advance their active tiles this way, a generation at a
+ * time; passes over the whole board did not beat plain updates,
+ * not even on boards far beyond the last level cache. */
+class TemporalBlocker {
+
+    /* Working memory of a thread, reused from tile to tile. */
+    struct TileBuffers {
+        cells_t cells, nextCells;
+        mask_t alive, nextAlive;
+        std::unique_ptr<NeighborCounter> counter;
+        std::unique_ptr<BitSliceStepper> bitSlicer;
+        std::vector<count_t> neighbors;
+    };
+
+    const BoardArgs args;
+    const bool isBitSliced;
+    const RuleTable rules;
+    const RowKernels &kernels;
+    ThreadPool *pool;
+    std::vector<TileBuffers> tileBuffers;
+
+public:
+
+    /* Keeps working memory for each thread of 'threadPool', or
+     * for the calling thread only, if it is null. */
+    explicit TemporalBlocker(const BoardArgs &boardArgs, ThreadPool *threadPool = nullptr);
+
+    /* Writes the cells and the alive mask, 'depth' generations
+     * later, of the cells in rows [first, last) and in columns of
+     * mask words [firstWord, lastWord) only; other cells of the
+     * next buffers are left untouched. The cells are left out (and
+     * may be empty) when rules are advanced on the alive mask only.
+     * Calls with distinct 'band' indices, below the thread count of
+     * the pool, can run at the same time. Changes of the written
+     * cells are added to 'delta', unless it is null. */
+    void stepRegion(size_t band, const cells_t &cells, const mask_t &alive,
+                    cells_t &nextCells, mask_t &nextAlive, size_t width,
+                    size_t first, size_t last, size_t firstWord, size_t lastWord, size_t depth,
+                    StatsDelta *delta = nullptr);
+
+private:
+
+    /* Advances the copy of a tile a single generation. */
+    void advanceTile(TileBuffers &buffers, size_t width) const;
+};
@@ -1,162 +1,1104 @@
 #include "board.hpp"
+#include "counting.hpp"
+#include "bitslice.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include "blocking.hpp"
+#include "incremental.hpp"
+#include "neighborhood.hpp"
+#include "stats.hpp"
 #include <stdexcept>
 #include <random>
 #include <utility>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+
+/* Returns the seconds of wall time passed since 'start'. */
+double getSecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* Runs a phase of a generation, adding its wall time
+ * to 'seconds' if metrics are recorded. */
+template<typename Phase>
+void runPhase(bool isTimed, double &seconds, Phase phase) {
+    if (!isTimed) {
+        phase();
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    phase();
+    seconds += getSecondsSince(start);
+}
 
 Board::Board(BoardArgs boardArgs) : args(std::move(boardArgs)) {
+    cells = cells_t(args.height, args.width);
     checkArgsCorrect();
 
-    std::set<cell_t> aliveCells;
+    std::set<size_t> aliveCells;
     getRandomStartCells(aliveCells);
 
-    for (size_t row = 0, cellId = 0; row < cells.size(); ++row) {
-        cells[row] = row_t();
-        for (size_t col = 0; col < cells[0].size(); ++col, ++cellId) {
+    for (size_t row = 0, cellId = 0; row < cells.getHeight(); ++row) {
+        for (size_t col = 0; col < cells.getWidth(); ++col, ++cellId) {
             if (aliveCells.find(cellId) != aliveCells.cend())
                 cells[row][col] = 1; // make cell fully alive
             else
                 cells[row][col] = 0; // make cell dead
         }
     }
+    initUpdate();
 }
 
 Board::Board(BoardArgs boardArgs, const cells_t &startState)
         : args(std::move(boardArgs)), cells(startState) {
     checkArgsCorrect();
+    initUpdate();
+}
+
+Board::Board(BoardArgs boardArgs, cells_t savedCells, size_t startGeneration)
+        : args(std::move(boardArgs)), cells(std::move(savedCells)), generation(startGeneration) {
+    checkArgsCorrect(true);
+    initUpdate();
 }
 
+Board::Board(Board &&other) noexcept = default;
+
+Board::~Board() = default;
+
 void Board::update() {
-    snapshot = cells; // save a snapshot of the current cell states
-    for (size_t row = 0; row < cells.size(); ++row) {
-        for (size_t col = 0; col < cells[0].size(); ++col) {
-            cell_t state = cells[row][col];
-            if (state == 0) {
-                // cell is dead
-                if (testBirthConditions(row, col))
-                    cells[row][col] = 1;
+    std::chrono::steady_clock::time_point start;
+    if (isMetricsRecorded) {
+        metrics = GenerationMetrics();
+        start = std::chrono::steady_clock::now();
+    }
+
+    advance();
+    // the back buffers hold the last generation
+    if (isChangesRecorded)
+        findChanges(nextCells, nextAliveMask, false, changes);
+    if (isStatsRecorded) {
+        mergeStats();
+        finishStats();
+    }
+    if (isCyclesTracked)
+        updateHash(nextCells, nextAliveMask);
+    runPhase(isMetricsRecorded, metrics.copySeconds, [this] { refreshSharedCells(); });
+
+    if (isMetricsRecorded) {
+        metrics.generations = 1;
+        metrics.totalSeconds = getSecondsSince(start);
+        findTransitions(nextCells, nextAliveMask, false);
+    }
+}
+
+void Board::advance() {
+    ++generation;
+    const bool isTiled = findActiveTiles();
+    cheapGenerations = isIncrementalCheaper() ? cheapGenerations + 1 : 0;
+    if (cheapGenerations > 0 && (incremental->isReady() || cheapGenerations >= INCREMENTAL_WARMUP_GENERATIONS)) {
+        updateIncremental();
+        return;
+    }
+    if (incremental)
+        incremental->invalidate();
+    isLastGenerationKept = true;
+
+    if (isTiled) {
+        if (isMetricsRecorded)
+            metrics.cellsSkipped += cells.getHeight() * cells.getWidth() - getActiveCellCount();
+        runPhase(isMetricsRecorded, metrics.countSeconds, [this] { updateActiveTiles(); });
+    }
+    else if (bitSlicer)
+        updateBitSliced();
+    else
+        updateCounted();
+    findChangedTiles();
+}
+
+void Board::step(size_t generations) {
+    std::chrono::steady_clock::time_point start;
+    if (isMetricsRecorded) {
+        metrics = GenerationMetrics();
+        metrics.generations = generations;
+        start = std::chrono::steady_clock::now();
+    }
+
+    // the back buffers hold only the last generation,
+    // so the start is kept aside
+    if (isChangesRecorded || isMetricsRecorded) {
+        runPhase(isMetricsRecorded, metrics.copySeconds, [this] {
+            if (bitSlicer)
+                stepStartMask = aliveMask;
+            else
+                stepStartCells = cells;
+        });
+    }
+
+    for (size_t done = 0; done < generations; ++done) {
+        advance();
+        if (isCyclesTracked)
+            updateHash(nextCells, nextAliveMask);
+    }
+    if (isChangesRecorded)
+        findChanges(stepStartCells, stepStartMask, true, changes);
+    // changes of all generations are gathered before they are merged
+    if (isStatsRecorded) {
+        mergeStats();
+        finishStats();
+    }
+    runPhase(isMetricsRecorded, metrics.copySeconds, [this] { refreshSharedCells(); });
+
+    if (isMetricsRecorded) {
+        metrics.totalSeconds = getSecondsSince(start);
+        findTransitions(stepStartCells, stepStartMask, true);
+    }
+}
+
+void Board::updateCounted() {
+    if (isWrapped()) {
+        runPhase(isMetricsRecorded, metrics.copySeconds, [this] { fillWrappedMask(); });
+        runPhase(isMetricsRecorded, metrics.countSeconds, [this] {
+            counter->prepare(wrappedMask, cells.getWidth() + 2 * haloCols);
+        });
+    } else {
+        runPhase(isMetricsRecorded, metrics.countSeconds, [this] { counter->prepare(aliveMask, cells.getWidth()); });
+    }
+
+    // Bands read the current generation only, and write
+    // disjoint rows of the next one
+    const TransitionView view = rules.getView();
+    if (!isMetricsRecorded) {
+        forEachBand(pool.get(), cells.getHeight(), [&](size_t band, size_t first, size_t last) {
+            advanceRows(*counter, *kernels, view, cells, nextCells, nextAliveMask, first, last, neighbors[band],
+                        haloRows, haloCols, getStatsDelta(band));
+        });
+    } else {
+        // bands time both phases of every row, and the wall time
+        // of all bands is split between the phases in proportion
+        const auto start = std::chrono::steady_clock::now();
+        bandSeconds.assign(2 * neighbors.getHeight(), 0);
+        forEachBand(pool.get(), cells.getHeight(), [&](size_t band, size_t first, size_t last) {
+            StatsDelta *delta = getStatsDelta(band);
+            for (size_t row = first; row < last; ++row) {
+                runPhase(true, bandSeconds[2 * band], [&] { counter->countRow(row + haloRows, neighbors[band]); });
+                runPhase(true, bandSeconds[2 * band + 1], [&] {
+                    kernels->transitionRow(view, cells[row], neighbors[band] + haloCols, nextCells[row],
+                                           nextAliveMask[row], cells.getWidth());
+                    if (delta)
+                        addCellsDelta(cells[row], nextCells[row], row, 0, cells.getWidth(), *delta);
+                });
             }
-            else if (state > 1 || !testSurvivalConditions(row, col)) {
-                // cell is alive, but aging
-                if (++cells[row][col] == args.states) {
-                    // cell has lived a full lifetime
-                    cells[row][col] = 0;
-                }
+        });
+        const double seconds = getSecondsSince(start);
+        double countSeconds = 0, transitionSeconds = 0;
+        for (size_t band = 0; band < neighbors.getHeight(); ++band) {
+            countSeconds += bandSeconds[2 * band];
+            transitionSeconds += bandSeconds[2 * band + 1];
+        }
+        const double share = countSeconds + transitionSeconds > 0 ? countSeconds / (countSeconds + transitionSeconds) : 0;
+        metrics.countSeconds += share * seconds;
+        metrics.transitionSeconds += (1 - share) * seconds;
+    }
+
+    // the next generation becomes current, the old buffers are reused
+    std::swap(cells, nextCells);
+    std::swap(aliveMask, nextAliveMask);
+}
+
+void Board::updateBitSliced() {
+    if (isWrapped()) {
+        runPhase(isMetricsRecorded, metrics.copySeconds, [this] { fillWrappedMask(); });
+        runPhase(isMetricsRecorded, metrics.countSeconds, [this] {
+            bitSlicer->step(wrappedMask, wrappedNextMask, cells.getWidth() + 2 * haloCols);
+        });
+        runPhase(isMetricsRecorded, metrics.copySeconds, [this] { readWrappedMask(); });
+    } else {
+        runPhase(isMetricsRecorded, metrics.countSeconds, [this] {
+            bitSlicer->step(aliveMask, nextAliveMask, cells.getWidth(), isStatsRecorded ? statsDeltas.data() : nullptr);
+        });
+    }
+    std::swap(aliveMask, nextAliveMask);
+    isCellsOutdated = true;
+}
+
+void Board::updateIncremental() {
+    // the back buffers are brought to the current generation, so
+    // that the changes make them the next one
+    if (!incremental->isReady()) {
+        runPhase(isMetricsRecorded, metrics.copySeconds, [this] { syncCells(); });
+        runPhase(isMetricsRecorded, metrics.countSeconds, [this] { incremental->reset(aliveMask, cells.getWidth()); });
+
+        // cells changed by the last generation, or with changed
+        // counts, are the only ones which can change in the next
+        findChanges(nextCells, nextAliveMask, false, seedChanges);
+        for (const CellChange &change : seedChanges)
+            incremental->addChange(change.row, change.col,
+                                   isMaskBitSet(aliveMask[change.row], change.col)
+                                   != isMaskBitSet(nextAliveMask[change.row], change.col));
+        runPhase(isMetricsRecorded, metrics.copySeconds, [this] {
+            nextAliveMask = aliveMask;
+            if (!bitSlicer)
+                nextCells = cells;
+        });
+    } else {
+        runPhase(isMetricsRecorded, metrics.copySeconds, [this] { incremental->writeChanges(nextCells, nextAliveMask); });
+    }
+    if (isMetricsRecorded)
+        metrics.cellsSkipped += cells.getHeight() * cells.getWidth() - incremental->getCandidateCount();
+    runPhase(isMetricsRecorded, metrics.countSeconds, [this] {
+        incremental->step(rules, cells, aliveMask, nextCells, nextAliveMask);
+    });
+    if (isStatsRecorded) {
+        for (const CellChange &change : incremental->getChanges()) {
+            if (!bitSlicer) {
+                addCellsDelta(cells[change.row] + change.col, nextCells[change.row] + change.col,
+                              change.row, change.col, 1, statsDeltas[0]);
+                continue;
             }
+            const size_t word = change.col / MASK_WORD_BITS;
+            const mask_word_t bit = (mask_word_t) 1 << (change.col % MASK_WORD_BITS);
+            addWordDelta(aliveMask[change.row][word] & bit, nextAliveMask[change.row][word] & bit,
+                         change.row, word, statsDeltas[0]);
         }
     }
+
+    std::swap(aliveMask, nextAliveMask);
+    if (!bitSlicer)
+        std::swap(cells, nextCells);
+    else if (!incremental->getChanges().empty())
+        isCellsOutdated = true;
+
+    // visited cells lie within the active tiles found for this
+    // generation, so their count is left as it is
+    changedTiles.clear();
+    for (const CellChange &change : incremental->getChanges())
+        changedTiles[change.row / ACTIVE_TILE_ROWS][change.col / (ACTIVE_TILE_WORDS * MASK_WORD_BITS)] = 1;
 }
 
-const cells_t & Board::getCells() const {
-    return cells;
+bool Board::isIncrementalCheaper() const {
+    // without the last generation, every cell would have to be visited
+    if (!incremental || (!incremental->isReady() && !isLastGenerationKept))
+        return false;
+
+    const size_t footprint = incremental->getFootprintSize();
+    const size_t fullCost = bitSlicer ? BITSLICED_WORD_COST * activeWork
+                                      : COUNTED_CELL_COST * MASK_WORD_BITS * activeWork;
+
+    // flips of the last generation stand for the flips of the next one
+    if (incremental->isReady())
+        return INCREMENTAL_COUNT_COST * incremental->getFlipCount() * footprint
+               + INCREMENTAL_VISIT_COST * incremental->getCandidateCount() < fullCost;
+
+    // before the engine runs, the cells it would visit are the footprints
+    // of the flips and the cells changed without a flip; changed tiles
+    // are only scanned until the cost is known to be too high
+    const size_t flipCost = (INCREMENTAL_COUNT_COST + INCREMENTAL_VISIT_COST) * footprint;
+    const size_t words = aliveMask.getWidth();
+    size_t cost = 0;
+    for (size_t tileRow = 0; tileRow < changedTiles.getHeight(); ++tileRow) {
+        const size_t firstRow = tileRow * ACTIVE_TILE_ROWS;
+        const size_t lastRow = std::min(firstRow + ACTIVE_TILE_ROWS, cells.getHeight());
+        for (size_t tile = 0; tile < changedTiles.getWidth(); ++tile) {
+            if (!changedTiles[tileRow][tile]) continue;
+            const size_t lastWord = std::min((tile + 1) * ACTIVE_TILE_WORDS, words);
+            const size_t firstCol = tile * ACTIVE_TILE_WORDS * MASK_WORD_BITS;
+            const size_t lastCol = std::min(lastWord * MASK_WORD_BITS, cells.getWidth());
+            size_t flips = 0, changed = 0;
+            for (size_t row = firstRow; row < lastRow; ++row) {
+                for (size_t word = tile * ACTIVE_TILE_WORDS; word < lastWord; ++word)
+                    flips += (size_t) __builtin_popcountll(aliveMask[row][word] ^ nextAliveMask[row][word]);
+                if (!bitSlicer)
+                    for (size_t col = firstCol; col < lastCol; ++col)
+                        changed += cells[row][col] != nextCells[row][col];
+            }
+            cost += flipCost * flips + INCREMENTAL_VISIT_COST * changed;
+            if (cost >= fullCost)
+                return false;
+        }
+    }
+    return cost < fullCost;
 }
 
-size_t Board::getSize() const {
-    return cells.size();
+void Board::updateActiveTiles() {
+    const size_t words = aliveMask.getWidth();
+    forEachBand(pool.get(), activeTiles.getHeight(), [&](size_t band, size_t first, size_t last) {
+        StatsDelta *delta = getStatsDelta(band);
+        for (size_t tileRow = first; tileRow < last; ++tileRow) {
+            const std::uint8_t *rowTiles = activeTiles[tileRow];
+            const size_t firstRow = tileRow * ACTIVE_TILE_ROWS;
+            const size_t lastRow = std::min(firstRow + ACTIVE_TILE_ROWS, cells.getHeight());
+
+            // runs of adjacent active tiles share their ghost cells
+            for (size_t tile = 0; tile < activeTiles.getWidth(); ) {
+                if (!rowTiles[tile]) {
+                    ++tile;
+                    continue;
+                }
+                size_t end = tile;
+                while (end < activeTiles.getWidth() && rowTiles[end]) ++end;
+                blocker->stepRegion(band, cells, aliveMask, nextCells, nextAliveMask, cells.getWidth(),
+                                    firstRow, lastRow, tile * ACTIVE_TILE_WORDS,
+                                    std::min(end * ACTIVE_TILE_WORDS, words), 1, delta);
+                tile = end;
+            }
+        }
+    });
+
+    std::swap(aliveMask, nextAliveMask);
+    if (bitSlicer)
+        isCellsOutdated = true;
+    else
+        std::swap(cells, nextCells);
 }
 
-void Board::checkArgsCorrect() const {
-    if (args.neighborhoodRadius > NEIGHBORHOOD_RADIUS_MAX
-    || args.neighborhoodRadius < NEIGHBORHOOD_RADIUS_MIN)
-        throw std::invalid_argument("Neighborhood radius out of range");
+bool Board::isWrapped() const {
+    return haloRows != 0 || haloCols != 0;
+}
 
-    if (args.states > STATES_MAX || args.states < STATES_MIN)
-        throw std::invalid_argument("States count out of range");
+void Board::fillWrappedMask() {
+    const size_t height = cells.getHeight(), width = cells.getWidth();
+    const size_t words = aliveMask.getWidth();
+    const size_t shift = haloCols % MASK_WORD_BITS;
+    forEachBand(pool.get(), wrappedMask.getHeight(), [&](size_t, size_t first, size_t last) {
+        for (size_t row = first; row < last; ++row) {
+            // the halo may be larger than the board, so it can
+            // repeat the board more than once
+            const mask_word_t *source = aliveMask[(row % height + height - haloRows % height) % height];
+            mask_word_t *target = wrappedMask[row];
+            std::fill(target, target + wrappedMask.getWidth(), 0);
 
-    if (args.birthConds.empty())
-        throw std::invalid_argument("No birth conditions specified");
+            // bits of the row moved right by the halo width
+            for (size_t word = 0; word < words; ++word) {
+                const size_t targetWord = word + haloCols / MASK_WORD_BITS;
+                target[targetWord] |= source[word] << shift;
+                if (shift != 0 && targetWord + 1 < wrappedMask.getWidth())
+                    target[targetWord + 1] |= source[word] >> (MASK_WORD_BITS - shift);
+            }
 
-    if (args.surviveConds.empty())
-        throw std::invalid_argument("No survival conditions specified");
+            for (size_t col = 0; col < haloCols; ++col) {
+                const size_t left = (col % width + width - haloCols % width) % width;
+                const size_t right = col % width;
+                target[col / MASK_WORD_BITS] |= (mask_word_t) isMaskBitSet(source, left) << (col % MASK_WORD_BITS);
+                const size_t rightCol = haloCols + width + col;
+                target[rightCol / MASK_WORD_BITS] |= (mask_word_t) isMaskBitSet(source, right) << (rightCol % MASK_WORD_BITS);
+            }
+        }
+    });
+}
 
-    for (auto row : cells) {
-        for (auto cell : row) {
-            if (cell != 0 && cell != 1)
-                throw std::invalid_argument("Start cell values in the array can only be 0 or 1");
+void Board::readWrappedMask() {
+    const size_t width = cells.getWidth();
+    const size_t words = aliveMask.getWidth();
+    const size_t shift = haloCols % MASK_WORD_BITS;
+    const mask_word_t lastWordMask = ~(mask_word_t) 0 >> ((MASK_WORD_BITS - width % MASK_WORD_BITS) % MASK_WORD_BITS);
+    forEachBand(pool.get(), cells.getHeight(), [&](size_t band, size_t first, size_t last) {
+        StatsDelta *delta = getStatsDelta(band);
+        for (size_t row = first; row < last; ++row) {
+            const mask_word_t *source = wrappedNextMask[row + haloRows];
+            mask_word_t *target = nextAliveMask[row];
+            for (size_t word = 0; word < words; ++word) {
+                const size_t sourceWord = word + haloCols / MASK_WORD_BITS;
+                mask_word_t bits = source[sourceWord] >> shift;
+                if (shift != 0 && sourceWord + 1 < wrappedNextMask.getWidth())
+                    bits |= source[sourceWord + 1] << (MASK_WORD_BITS - shift);
+                if (word == words - 1)
+                    bits &= lastWordMask;
+                target[word] = bits;
+                if (delta)
+                    addWordDelta(aliveMask[row][word], bits, row, word, *delta);
+            }
         }
-    }
+    });
 }
 
-void Board::getRandomStartCells(std::set<cell_t> &cellSet) const {
-    std::random_device dev;
-    std::mt19937 generator(dev());
-    std::uniform_int_distribution<std::mt19937::result_type> dist(0, (cells.size()*cells.size())-1);
+bool Board::findActiveTiles() {
+    // changes travel across wrapped edges, which tiles do not follow
+    if (isWrapped()) {
+        activeTileCount = getTileCount();
+        activeWork = cells.getHeight() * aliveMask.getWidth();
+        return false;
+    }
 
-    while (cellSet.size() != START_CELLS_ALIVE) {
-        cellSet.insert(dist(generator));
+    const size_t tileRows = activeTiles.getHeight();
+    const size_t tileCols = activeTiles.getWidth();
+    const size_t words = aliveMask.getWidth();
+    const size_t radius = (size_t) args.neighborhoodRadius;
+    const size_t tileWidth = ACTIVE_TILE_WORDS * MASK_WORD_BITS;
+    const size_t rowReach = (radius + ACTIVE_TILE_ROWS - 1) / ACTIVE_TILE_ROWS;
+    const size_t colReach = (radius + tileWidth - 1) / tileWidth;
+
+    // A change can affect cells up to the radius away
+    activeTiles.clear();
+    for (size_t tileRow = 0; tileRow < tileRows; ++tileRow) {
+        for (size_t tile = 0; tile < tileCols; ++tile) {
+            if (!changedTiles[tileRow][tile]) continue;
+            const size_t lastRow = std::min(tileRow + rowReach + 1, tileRows);
+            const size_t lastCol = std::min(tile + colReach + 1, tileCols);
+            for (size_t row = (tileRow < rowReach ? 0 : tileRow - rowReach); row < lastRow; ++row)
+                for (size_t col = (tile < colReach ? 0 : tile - colReach); col < lastCol; ++col)
+                    activeTiles[row][col] = 1;
+        }
+    }
+
+    // Runs of active tiles are computed with their ghost cells,
+    // which is not worth it when they cover most of the board
+    const size_t ghostWords = (radius + MASK_WORD_BITS - 1) / MASK_WORD_BITS;
+    size_t work = 0;
+    activeTileCount = 0;
+    for (size_t tileRow = 0; tileRow < tileRows; ++tileRow) {
+        const size_t rows = std::min(ACTIVE_TILE_ROWS, cells.getHeight() - tileRow * ACTIVE_TILE_ROWS);
+        for (size_t tile = 0; tile < tileCols; ) {
+            if (!activeTiles[tileRow][tile]) {
+                ++tile;
+                continue;
+            }
+            size_t end = tile;
+            while (end < tileCols && activeTiles[tileRow][end]) ++end;
+            const size_t runWords = std::min(end * ACTIVE_TILE_WORDS, words) - tile * ACTIVE_TILE_WORDS;
+            work += (rows + 2 * radius) * (runWords + 2 * ghostWords);
+            activeTileCount += end - tile;
+            tile = end;
+        }
     }
+    if (2 * work < cells.getHeight() * words) {
+        activeWork = work;
+        return true;
+    }
+
+    activeWork = cells.getHeight() * words;
+    for (size_t tileRow = 0; tileRow < tileRows; ++tileRow)
+        std::fill(activeTiles[tileRow], activeTiles[tileRow] + tileCols, 1);
+    activeTileCount = getTileCount();
+    return false;
 }
 
-/* ---------- Helpers for calculating offset ---------- */
+void Board::findChangedTiles() {
+    if (isWrapped()) return;
+    const size_t width = cells.getWidth();
+    const size_t words = aliveMask.getWidth();
+    forEachBand(pool.get(), changedTiles.getHeight(), [&](size_t, size_t first, size_t last) {
+        for (size_t tileRow = first; tileRow < last; ++tileRow) {
+            const size_t firstRow = tileRow * ACTIVE_TILE_ROWS;
+            const size_t lastRow = std::min(firstRow + ACTIVE_TILE_ROWS, cells.getHeight());
+            for (size_t tile = 0; tile < changedTiles.getWidth(); ++tile) {
+                // skipped tiles are known to be unchanged, and the
+                // back buffers of active tiles hold the last generation
+                bool isChanged = false;
+                for (size_t row = firstRow; row < lastRow && !isChanged && activeTiles[tileRow][tile]; ++row) {
+                    if (bitSlicer) {
+                        const size_t firstWord = tile * ACTIVE_TILE_WORDS;
+                        const size_t lastWord = std::min(firstWord + ACTIVE_TILE_WORDS, words);
+                        isChanged = !std::equal(aliveMask[row] + firstWord, aliveMask[row] + lastWord,
+                                                nextAliveMask[row] + firstWord);
+                    } else {
+                        const size_t firstCol = tile * ACTIVE_TILE_WORDS * MASK_WORD_BITS;
+                        const size_t lastCol = std::min(firstCol + ACTIVE_TILE_WORDS * MASK_WORD_BITS, width);
+                        isChanged = !std::equal(cells[row] + firstCol, cells[row] + lastCol,
+                                                nextCells[row] + firstCol);
+                    }
+                }
+                changedTiles[tileRow][tile] = isChanged;
+            }
+        }
+    });
+}
 
-inline bool isCorrectOffset(size_t coord, int offset) {
-    return (offset > -1 || coord >= (size_t) (-offset));
+void Board::findChanges(const cells_t &lastCells, const mask_t &lastMask, bool isEveryTile,
+                        std::vector<CellChange> &found) {
+    const size_t width = cells.getWidth();
+    const size_t words = aliveMask.getWidth();
+    found.clear();
+    for (size_t tileRow = 0; tileRow < changedTiles.getHeight(); ++tileRow) {
+        const size_t firstRow = tileRow * ACTIVE_TILE_ROWS;
+        const size_t lastRow = std::min(firstRow + ACTIVE_TILE_ROWS, cells.getHeight());
+        for (size_t row = firstRow; row < lastRow; ++row) {
+            for (size_t tile = 0; tile < changedTiles.getWidth(); ++tile) {
+                if (!isEveryTile && !changedTiles[tileRow][tile]) continue;
+
+                const size_t firstWord = tile * ACTIVE_TILE_WORDS;
+                if (bitSlicer) {
+                    // only differing bits are visited
+                    const size_t lastWord = std::min(firstWord + ACTIVE_TILE_WORDS, words);
+                    for (size_t word = firstWord; word < lastWord; ++word) {
+                        const mask_word_t bits = aliveMask[row][word];
+                        for (mask_word_t diff = bits ^ lastMask[row][word]; diff != 0; diff &= diff - 1) {
+                            const size_t bit = (size_t) __builtin_ctzll(diff);
+                            found.push_back({(std::uint32_t) row, (std::uint32_t) (word * MASK_WORD_BITS + bit),
+                                               (std::uint32_t) ((bits >> bit) & 1)});
+                        }
+                    }
+                } else {
+                    const size_t firstCol = firstWord * MASK_WORD_BITS;
+                    const size_t lastCol = std::min(firstCol + ACTIVE_TILE_WORDS * MASK_WORD_BITS, width);
+                    const cell_t *rowCells = cells[row];
+                    const cell_t *lastRowCells = lastCells[row];
+                    for (size_t col = firstCol; col < lastCol; ++col) {
+                        if (rowCells[col] != lastRowCells[col])
+                            found.push_back({(std::uint32_t) row, (std::uint32_t) col, rowCells[col]});
+                    }
+                }
+            }
+        }
+    }
 }
 
-inline size_t addOffset(size_t coord, int offset) {
-    if (offset < 0) {
-        if (coord < (size_t) (-offset))
-            throw std::invalid_argument("Negative offset greater than coordinate");
+void Board::findTransitions(const cells_t &lastCells, const mask_t &lastMask, bool isEveryTile) {
+    const size_t width = cells.getWidth();
+    const size_t words = aliveMask.getWidth();
+    for (size_t tileRow = 0; tileRow < changedTiles.getHeight(); ++tileRow) {
+        const size_t firstRow = tileRow * ACTIVE_TILE_ROWS;
+        const size_t lastRow = std::min(firstRow + ACTIVE_TILE_ROWS, cells.getHeight());
+        for (size_t tile = 0; tile < changedTiles.getWidth(); ++tile) {
+            if (!isEveryTile && !changedTiles[tileRow][tile]) continue;
 
-        return coord - (size_t) (-offset);
+            const size_t firstWord = tile * ACTIVE_TILE_WORDS;
+            for (size_t row = firstRow; row < lastRow; ++row) {
+                if (bitSlicer) {
+                    // two states only, so every change is a birth or a death
+                    const size_t lastWord = std::min(firstWord + ACTIVE_TILE_WORDS, words);
+                    for (size_t word = firstWord; word < lastWord; ++word) {
+                        const mask_word_t bits = aliveMask[row][word], lastBits = lastMask[row][word];
+                        metrics.births += (size_t) __builtin_popcountll(bits & ~lastBits);
+                        metrics.deaths += (size_t) __builtin_popcountll(lastBits & ~bits);
+                    }
+                    continue;
+                }
+                const size_t firstCol = firstWord * MASK_WORD_BITS;
+                const size_t lastCol = std::min(firstCol + ACTIVE_TILE_WORDS * MASK_WORD_BITS, width);
+                const cell_t *rowCells = cells[row];
+                const cell_t *lastRowCells = lastCells[row];
+                for (size_t col = firstCol; col < lastCol; ++col) {
+                    if (rowCells[col] == lastRowCells[col]) continue;
+                    if (rowCells[col] == 0)
+                        ++metrics.deaths;
+                    else if (rowCells[col] == 1)
+                        ++metrics.births;
+                    else
+                        ++metrics.agings;
+                }
+            }
+        }
     }
-    return coord + (size_t) offset;
+
+    for (size_t row = 0; row < aliveMask.getHeight(); ++row)
+        for (size_t word = 0; word < words; ++word)
+            metrics.population += (size_t) __builtin_popcountll(aliveMask[row][word]);
 }
 
-/* --------------------------------------------------- */
+void Board::countStats() {
+    const size_t height = cells.getHeight(), width = cells.getWidth();
+    stats.histogram.assign((size_t) args.states, 0);
+    rowLiveCounts.assign(height, 0);
+    colLiveCounts.assign(bitSlicer ? aliveMask.getWidth() : width, 0);
+    liveBitIndexSum = 0;
+
+    for (size_t row = 0; row < height; ++row) {
+        // cells lag behind the mask of bit-sliced rules
+        if (bitSlicer) {
+            for (size_t word = 0; word < aliveMask.getWidth(); ++word) {
+                const mask_word_t bits = aliveMask[row][word];
+                const size_t count = (size_t) __builtin_popcountll(bits);
+                rowLiveCounts[row] += count;
+                colLiveCounts[word] += count;
+                liveBitIndexSum += getBitIndexSum(bits);
+            }
+            continue;
+        }
+        for (size_t col = 0; col < width; ++col) {
+            const cell_t state = cells[row][col];
+            ++stats.histogram[state];
+            if (state == 0) continue;
+            ++rowLiveCounts[row];
+            ++colLiveCounts[col];
+        }
+    }
+    if (bitSlicer) {
+        stats.histogram[1] = std::accumulate(rowLiveCounts.cbegin(), rowLiveCounts.cend(), (size_t) 0);
+        stats.histogram[0] = height * width - stats.histogram[1];
+    }
+
+    statsDeltas.resize(getBandCount(pool.get(), height));
+    for (StatsDelta &delta : statsDeltas) {
+        delta.histogram.assign(STATS_HISTOGRAM_LANES * stats.histogram.size(), 0);
+        delta.colCounts.assign(colLiveCounts.size(), 0);
+        delta.rowCounts = rowLiveCounts.data();
+        delta.bitIndexSum = 0;
+    }
+    finishStats();
+}
 
-bool Board::testBirthConditions(size_t row, size_t col) const {
-    if (snapshot[row][col] != 0) return false; // cell not dead
-    return testConditions(row, col, args.birthConds);
+StatsDelta *Board::getStatsDelta(size_t band) {
+    return isStatsRecorded ? &statsDeltas[band] : nullptr;
 }
 
-bool Board::testSurvivalConditions(size_t row, size_t col) const {
-    if (snapshot[row][col] != 1) return false; // cell not fully alive
-    return testConditions(row, col, args.surviveConds);
+void Board::mergeStats() {
+    // counts of rows are adjusted by the bands themselves
+    for (StatsDelta &delta : statsDeltas) {
+        for (size_t index = 0; index < delta.histogram.size(); ++index) {
+            stats.histogram[index % stats.histogram.size()] += delta.histogram[index];
+            delta.histogram[index] = 0;
+        }
+        for (size_t col = 0; col < delta.colCounts.size(); ++col) {
+            colLiveCounts[col] += delta.colCounts[col];
+            delta.colCounts[col] = 0;
+        }
+        liveBitIndexSum += delta.bitIndexSum;
+        delta.bitIndexSum = 0;
+    }
 }
 
-bool Board::testConditions(size_t row, size_t col, const conds_t &conds) const {
-    int maxNeighbors = *conds.crbegin();
+void Board::finishStats() {
+    stats.liveCount = cells.getHeight() * cells.getWidth() - stats.histogram[0];
+    if (stats.liveCount == 0) {
+        stats.top = stats.left = stats.bottom = stats.right = 0;
+        stats.centroidRow = stats.centroidCol = 0;
+        return;
+    }
+    auto isLive = [](size_t count) { return count != 0; };
+    stats.top = (size_t) (std::find_if(rowLiveCounts.begin(), rowLiveCounts.end(), isLive) - rowLiveCounts.begin());
+    stats.bottom = rowLiveCounts.size()
+                   - (size_t) (std::find_if(rowLiveCounts.rbegin(), rowLiveCounts.rend(), isLive) - rowLiveCounts.rbegin());
+    stats.left = (size_t) (std::find_if(colLiveCounts.begin(), colLiveCounts.end(), isLive) - colLiveCounts.begin());
+    stats.right = colLiveCounts.size()
+                  - (size_t) (std::find_if(colLiveCounts.rbegin(), colLiveCounts.rend(), isLive) - colLiveCounts.rbegin());
 
-    int neighbors = 0;
-    for (int offset = -args.neighborhoodRadius; offset <= args.neighborhoodRadius; ++offset) {
-        if (isCorrectOffset(row, offset)) {
-            // Add neighbors in a row
-            neighbors += getNeighborsInRow(row, col, offset);
+    // columns of bit-sliced rules are counted per word, and
+    // the indices of bits within words are summed on their own
+    const size_t colScale = bitSlicer ? MASK_WORD_BITS : 1;
+    size_t rowSum = 0, colSum = bitSlicer ? liveBitIndexSum : 0;
+    for (size_t row = stats.top; row < stats.bottom; ++row)
+        rowSum += row * rowLiveCounts[row];
+    for (size_t col = stats.left; col < stats.right; ++col)
+        colSum += col * colScale * colLiveCounts[col];
+    stats.centroidRow = (double) rowSum / (double) stats.liveCount;
+    stats.centroidCol = (double) colSum / (double) stats.liveCount;
 
-            // Is the count already too large?
-            if (neighbors > maxNeighbors) return false;
+    // bit-sliced rules count live cells per word, so the outermost
+    // words are merged over the rows of the box to find the columns
+    if (bitSlicer) {
+        const size_t leftWord = stats.left, rightWord = stats.right - 1;
+        mask_word_t leftBits = 0, rightBits = 0;
+        for (size_t row = stats.top; row < stats.bottom; ++row) {
+            leftBits |= aliveMask[row][leftWord];
+            rightBits |= aliveMask[row][rightWord];
         }
+        stats.left = leftWord * MASK_WORD_BITS + (size_t) __builtin_ctzll(leftBits);
+        stats.right = rightWord * MASK_WORD_BITS + MASK_WORD_BITS - (size_t) __builtin_clzll(rightBits);
     }
+}
 
-    return (conds.find(neighbors) != conds.cend());
+/* Returns a well mixed 64-bit value for 'value' (the
+ * finalizer of the splitmix64 generator), a bijection. */
+std::uint64_t mixHash(std::uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+    return value ^ (value >> 31);
 }
 
-int Board::getNeighborsInRow(size_t centerRow, size_t centerCol, int offset) const {
-    auto row = addOffset(centerRow, offset);
-    if (row >= snapshot.size())
-        return 0; // no neighbors in a non-existent row
+std::uint64_t Board::getUnitBits(const cells_t &unitCells, const mask_t &unitMask, size_t row, size_t unit) const {
+    if (bitSlicer)
+        return unitMask[row][unit];
 
-    const int start = (args.isMooreType ?
-                       -args.neighborhoodRadius :
-                       -args.neighborhoodRadius + std::abs(offset));
-    const int end = -start;
+    std::uint64_t bits = 0;
+    const size_t first = unit * sizeof(bits);
+    std::memcpy(&bits, unitCells[row] + first, std::min(sizeof(bits), unitCells.getWidth() - first));
+    return bits;
+}
 
-    int count = 0;
+std::uint64_t Board::getUnitHash(size_t row, size_t unit, std::uint64_t bits) const {
+    return mixHash(mixHash(row * getHashUnits() + unit + 1) ^ bits);
+}
+
+size_t Board::getHashUnits() const {
+    return bitSlicer ? aliveMask.getWidth() : (cells.getWidth() + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+}
+
+void Board::countHash() {
+    boardHash = emptyHash = 0;
+    for (size_t row = 0; row < cells.getHeight(); ++row) {
+        for (size_t unit = 0; unit < getHashUnits(); ++unit) {
+            boardHash ^= getUnitHash(row, unit, getUnitBits(cells, aliveMask, row, unit));
+            emptyHash ^= getUnitHash(row, unit, 0);
+        }
+    }
+
+    hashHistory.assign(CYCLE_HISTORY_SIZE, 0);
+    hashGenerations.clear();
+    cycleReport = CycleReport();
+    recordHash();
+}
 
-    for (int i = start; i <= end; ++i) {
-        if ((i > -1 || centerCol >= (size_t) (-i))) {
-            auto col = addOffset(centerCol, i);
-            if (col < snapshot.size()
-                && snapshot[row][col] == 1) {
-                    ++count; // neighbor cell found
+void Board::updateHash(const cells_t &lastCells, const mask_t &lastMask) {
+    // the behavior of a deterministic board does not change once found
+    if (cycleReport.evolution != Evolution::RUNNING)
+        return;
+
+    const size_t unitsPerTile = bitSlicer ? ACTIVE_TILE_WORDS
+                                          : ACTIVE_TILE_WORDS * MASK_WORD_BITS / sizeof(std::uint64_t);
+    const size_t units = getHashUnits();
+    for (size_t tileRow = 0; tileRow < changedTiles.getHeight(); ++tileRow) {
+        const size_t firstRow = tileRow * ACTIVE_TILE_ROWS;
+        const size_t lastRow = std::min(firstRow + ACTIVE_TILE_ROWS, cells.getHeight());
+        for (size_t tile = 0; tile < changedTiles.getWidth(); ++tile) {
+            if (!changedTiles[tileRow][tile]) continue;
+            const size_t lastUnit = std::min((tile + 1) * unitsPerTile, units);
+            for (size_t row = firstRow; row < lastRow; ++row) {
+                for (size_t unit = tile * unitsPerTile; unit < lastUnit; ++unit) {
+                    const std::uint64_t bits = getUnitBits(cells, aliveMask, row, unit);
+                    const std::uint64_t lastBits = getUnitBits(lastCells, lastMask, row, unit);
+                    if (bits != lastBits)
+                        boardHash ^= getUnitHash(row, unit, bits) ^ getUnitHash(row, unit, lastBits);
+                }
             }
         }
+    }
+    recordHash();
+}
 
+void Board::recordHash() {
+    if (boardHash == emptyHash && isBoardEmpty()) {
+        cycleReport = {Evolution::EXTINCT, 1, generation};
+        return;
     }
 
-    // Subtract center point, if it was unnecessarily counted
-    if (offset == 0 && !args.isIncludeCenter && snapshot[centerRow][centerCol] == 1)
-        --count;
+    const auto found = hashGenerations.find(boardHash);
+    if (found != hashGenerations.end()) {
+        const size_t period = generation - found->second;
+        cycleReport = {period == 1 ? Evolution::STILL_LIFE : Evolution::PERIODIC, period, generation};
+        return;
+    }
+
+    // the hash of the generation which leaves the history is forgotten,
+    // unless it has been seen again since
+    std::uint64_t &slot = hashHistory[generation % CYCLE_HISTORY_SIZE];
+    if (generation >= CYCLE_HISTORY_SIZE) {
+        const auto old = hashGenerations.find(slot);
+        if (old != hashGenerations.end() && old->second == generation - CYCLE_HISTORY_SIZE)
+            hashGenerations.erase(old);
+    }
+    slot = boardHash;
+    hashGenerations[boardHash] = generation;
+}
 
+bool Board::isBoardEmpty() const {
+    for (size_t row = 0; row < cells.getHeight(); ++row) {
+        if (bitSlicer) {
+            if (std::any_of(aliveMask[row], aliveMask[row] + aliveMask.getWidth(), [](mask_word_t word) { return word != 0; }))
+                return false;
+        } else if (std::any_of(cells[row], cells[row] + cells.getWidth(), [](cell_t cell) { return cell != 0; })) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t Board::getActiveCellCount() const {
+    const size_t tileWidth = ACTIVE_TILE_WORDS * MASK_WORD_BITS;
+    size_t count = 0;
+    for (size_t tileRow = 0; tileRow < activeTiles.getHeight(); ++tileRow) {
+        const size_t rows = std::min(ACTIVE_TILE_ROWS, cells.getHeight() - tileRow * ACTIVE_TILE_ROWS);
+        for (size_t tile = 0; tile < activeTiles.getWidth(); ++tile)
+            if (activeTiles[tileRow][tile])
+                count += rows * std::min(tileWidth, cells.getWidth() - tile * tileWidth);
+    }
     return count;
-}
\ No newline at end of file
+}
+
+void Board::markAllTilesChanged() {
+    for (size_t tileRow = 0; tileRow < changedTiles.getHeight(); ++tileRow)
+        std::fill(changedTiles[tileRow], changedTiles[tileRow] + changedTiles.getWidth(), 1);
+}
+
+void Board::syncCells() const {
+    if (!isCellsOutdated) return;
+    forEachBand(pool.get(), cells.getHeight(), [&](size_t, size_t first, size_t last) {
+        for (size_t row = first; row < last; ++row) {
+            const mask_word_t *rowMask = aliveMask[row];
+            cell_t *rowCells = cells[row];
+            for (size_t col = 0; col < cells.getWidth(); ++col)
+                rowCells[col] = isMaskBitSet(rowMask, col);
+        }
+    });
+    isCellsOutdated = false;
+}
+
+const cells_t & Board::getCells() const {
+    syncCells();
+    return cells;
+}
+
+const cells_t & Board::acquireSharedCells() {
+    if (sharedCellsHolders++ == 0)
+        sharedCells = getCells();
+    return sharedCells;
+}
+
+void Board::releaseSharedCells() {
+    if (sharedCellsHolders > 0)
+        --sharedCellsHolders;
+}
+
+void Board::refreshSharedCells() {
+    // same dimensions, so the copy keeps its buffer
+    if (sharedCellsHolders > 0)
+        sharedCells = getCells();
+}
+
+void Board::recordChanges(bool isEnabled) {
+    isChangesRecorded = isEnabled;
+    changes.clear();
+    if (!isEnabled) {
+        changes.shrink_to_fit();
+        if (!isMetricsRecorded) {
+            stepStartCells = cells_t();
+            stepStartMask = mask_t();
+        }
+    }
+}
+
+const std::vector<CellChange> & Board::getChanges() const {
+    return changes;
+}
+
+void Board::recordMetrics(bool isEnabled) {
+    isMetricsRecorded = isEnabled;
+    metrics = GenerationMetrics();
+    if (!isEnabled) {
+        bandSeconds = std::vector<double>();
+        if (!isChangesRecorded) {
+            stepStartCells = cells_t();
+            stepStartMask = mask_t();
+        }
+    }
+}
+
+const GenerationMetrics & Board::getMetrics() const {
+    return metrics;
+}
+
+void Board::recordStats(bool isEnabled) {
+    isStatsRecorded = isEnabled;
+    if (isEnabled) {
+        countStats();
+        return;
+    }
+    stats = BoardStats();
+    rowLiveCounts = std::vector<size_t>();
+    colLiveCounts = std::vector<size_t>();
+    statsDeltas = std::vector<StatsDelta>();
+}
+
+const BoardStats & Board::getStats() const {
+    return stats;
+}
+
+void Board::trackCycles(bool isEnabled) {
+    isCyclesTracked = isEnabled;
+    if (isEnabled) {
+        countHash();
+        return;
+    }
+    hashHistory = std::vector<std::uint64_t>();
+    hashGenerations = std::unordered_map<std::uint64_t, size_t>();
+    cycleReport = CycleReport();
+}
+
+const CycleReport & Board::getCycleReport() const {
+    return cycleReport;
+}
+
+size_t Board::getGeneration() const {
+    return generation;
+}
+
+const BoardArgs & Board::getArgs() const {
+    return args;
+}
+
+const mask_t & Board::getAliveMask() const {
+    return aliveMask;
+}
+
+size_t Board::getSize() const {
+    return cells.getWidth();
+}
+
+size_t Board::getWidth() const {
+    return cells.getWidth();
+}
+
+size_t Board::getHeight() const {
+    return cells.getHeight();
+}
+
+size_t Board::getTileCount() const {
+    return changedTiles.getHeight() * changedTiles.getWidth();
+}
+
+size_t Board::getActiveTileCount() const {
+    return activeTileCount;
+}
+
+void Board::checkArgsCorrect(bool isAnyStateAllowed) const {
+    checkRuleArgsCorrect(args);
+
+    if (args.width == 0 || args.height == 0)
+        throw std::invalid_argument("Board dimensions have to be positive");
+
+    if (cells.getWidth() != args.width || cells.getHeight() != args.height)
+        throw std::invalid_argument("Start cell array dimensions do not match the board size");
+
+    for (size_t row = 0; row < cells.getHeight(); ++row) {
+        const cell_t *rowCells = cells[row];
+        for (size_t col = 0; col < cells.getWidth(); ++col) {
+            if (isAnyStateAllowed && rowCells[col] >= args.states)
+                throw std::invalid_argument("Cell states in the array have to be below the state count");
+            if (!isAnyStateAllowed && rowCells[col] != 0 && rowCells[col] != 1)
+                throw std::invalid_argument("Start cell values in the array can only be 0 or 1");
+        }
+    }
+}
+
+void Board::getRandomStartCells(std::set<size_t> &cellSet) const {
+    const size_t cellCount = cells.getWidth() * cells.getHeight();
+    const size_t aliveCount = std::min(cellCount, (size_t) START_CELLS_ALIVE);
+
+    std::random_device dev;
+    std::mt19937_64 generator(dev());
+    std::uniform_int_distribution<size_t> dist(0, cellCount - 1);
+
+    while (cellSet.size() != aliveCount) {
+        cellSet.insert(dist(generator));
+    }
+}
+
+void Board::initUpdate() {
+    rules = RuleTable(args);
+    fillAliveMask(cells, aliveMask);
+    nextAliveMask = mask_t(aliveMask.getHeight(), aliveMask.getWidth());
+    if (args.threads > 1)
+        pool = std::make_unique<ThreadPool>((size_t) args.threads);
+
+    blocker = std::make_unique<TemporalBlocker>(args, pool.get());
+    const size_t tileRows = (cells.getHeight() + ACTIVE_TILE_ROWS - 1) / ACTIVE_TILE_ROWS;
+    const size_t tileCols = (aliveMask.getWidth() + ACTIVE_TILE_WORDS - 1) / ACTIVE_TILE_WORDS;
+    changedTiles = Grid<std::uint8_t>(tileRows, tileCols);
+    activeTiles = Grid<std::uint8_t>(tileRows, tileCols);
+    markAllTilesChanged();
+
+    const size_t radius = (size_t) args.neighborhoodRadius;
+    haloRows = args.isWrappedVertically ? radius : 0;
+    haloCols = args.isWrappedHorizontally ? radius : 0;
+    if (!isWrapped())
+        incremental = std::make_unique<IncrementalStepper>(args, pool.get());
+    if (isWrapped()) {
+        const size_t words = getMaskWords(cells.getWidth() + 2 * haloCols);
+        wrappedMask = mask_t(cells.getHeight() + 2 * haloRows, words);
+        wrappedNextMask = mask_t(cells.getHeight() + 2 * haloRows, words);
+    }
+
+    if (BitSliceStepper::isSupported(args)) {
+        bitSlicer = std::make_unique<BitSliceStepper>(args, pool.get());
+        return;
+    }
+
+    counter = makeNeighborCounter(args, pool.get());
+    kernels = &getRowKernels();
+    nextCells = cells_t(cells.getHeight(), cells.getWidth());
+    neighbors = Grid<count_t>(getBandCount(pool.get(), cells.getHeight()), cells.getWidth() + 2 * haloCols);
+}
+
+
+void fillAliveMask(const cells_t &cells, mask_t &mask) {
+    const size_t words = getMaskWords(cells.getWidth());
+    if (mask.getHeight() != cells.getHeight() || mask.getWidth() != words)
+        mask = mask_t(cells.getHeight(), words);
+
+    for (size_t row = 0; row < cells.getHeight(); ++row) {
+        const cell_t *rowCells = cells[row];
+        mask_word_t *rowMask = mask[row];
+        for (size_t word = 0; word < words; ++word)
+            rowMask[word] = 0;
+        for (size_t col = 0; col < cells.getWidth(); ++col)
+            rowMask[col / MASK_WORD_BITS] |= (mask_word_t) (rowCells[col] == 1) << (col % MASK_WORD_BITS);
+    }
+}
+
+
+void checkRuleArgsCorrect(const BoardArgs &boardArgs) {
+    if (boardArgs.neighborhoodRadius > NEIGHBORHOOD_RADIUS_MAX
+    || boardArgs.neighborhoodRadius < NEIGHBORHOOD_RADIUS_MIN)
+        throw std::invalid_argument("Neighborhood radius out of range");
+
+    if (boardArgs.states > STATES_MAX || boardArgs.states < STATES_MIN)
+        throw std::invalid_argument("States count out of range");
+
+    if (boardArgs.birthConds.empty())
+        throw std::invalid_argument("No birth conditions specified");
+
+    if (boardArgs.surviveConds.empty())
+        throw std::invalid_argument("No survival conditions specified");
+
+    if (boardArgs.threads > THREADS_MAX || boardArgs.threads < THREADS_MIN)
+        throw std::invalid_argument("Thread count out of range");
+
+    checkNeighborhoodArgsCorrect(boardArgs);
+}
+
+NeighborhoodType getNeighborhoodType(const BoardArgs &boardArgs) {
+    if (boardArgs.neighborhoodType == NeighborhoodType::MOORE && !boardArgs.isMooreType)
+        return NeighborhoodType::VON_NEUMANN;
+    return boardArgs.neighborhoodType;
+}
+
+count_t getNeighborhoodSize(const BoardArgs &boardArgs) {
+    const count_t radius = (count_t) boardArgs.neighborhoodRadius;
+    const NeighborhoodType type = getNeighborhoodType(boardArgs);
+    count_t size;
+    if (type == NeighborhoodType::MOORE)
+        size = (2 * radius + 1) * (2 * radius + 1);
+    else if (type == NeighborhoodType::VON_NEUMANN)
+        size = 2 * radius * (radius + 1) + 1;
+    else
+        size = NeighborhoodShape(boardArgs).getSize() + 1;
+    return boardArgs.isIncludeCenter ? size : size - 1;
+}
+
+RuleTable::RuleTable(const BoardArgs &boardArgs) : states(boardArgs.states) {
+    const long maxNeighbors = (long) getNeighborhoodSize(boardArgs);
+    auto isReachable = [maxNeighbors](int count) { return count >= 0 && count <= maxNeighbors; };
+
+    // A cell tested for survival is in state 1, so it adds
+    // itself to the count of its neighborhood
+    const size_t survivalShift = boardArgs.isIncludeCenter ? 0 : 1;
+
+    // Conditions which can never be met are left out
+    size_t largest = 0;
+    for (int count : boardArgs.birthConds)
+        if (isReachable(count)) largest = std::max(largest, (size_t) count);
+    for (int count : boardArgs.surviveConds)
+        if (isReachable(count)) largest = std::max(largest, (size_t) count + survivalShift);
+
+    lastCount = (count_t) largest + 1;
+    conditionBits.assign((size_t) lastCount + 4, 0);
+    for (int count : boardArgs.birthConds)
+        if (isReachable(count)) conditionBits[(size_t) count] |= BIRTH_BIT;
+    for (int count : boardArgs.surviveConds)
+        if (isReachable(count)) conditionBits[(size_t) count + survivalShift] |= SURVIVAL_BIT;
+
+    transitions.assign((size_t) boardArgs.states << 2, 0);
+    for (int state = 0; state < boardArgs.states; ++state) {
+        // cell is alive, but aging, until it has lived a full lifetime
+        const cell_t aged = (cell_t) (state + 1 == boardArgs.states ? 0 : state + 1);
+        for (std::uint8_t bits = 0; bits < 4; ++bits) {
+            cell_t next = aged;
+            if (state == 0) // cell is dead
+                next = (bits & BIRTH_BIT) ? 1 : 0;
+            else if (state == 1 && (bits & SURVIVAL_BIT))
+                next = 1; // cell survives
+            transitions[((size_t) state << 2) | bits] = next;
+        }
+    }
+}
@@ -1,23 +1,156 @@
 #pragma once
 #include <set>
-#include <array>
 #include <vector>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
 #include <cstddef>
+#include "grid.hpp"
 
 const int NEIGHBORHOOD_RADIUS_MIN = 1;
-const int NEIGHBORHOOD_RADIUS_MAX = 10;
+const int NEIGHBORHOOD_RADIUS_MAX = 500;
 
 const int STATES_MIN = 2;
 const int STATES_MAX = 256;
 
+const int THREADS_MIN = 1;
+const int THREADS_MAX = 256;
+
+/* Tiles tracked for changes span this many rows
+ * and this many words of the alive mask. */
+const size_t ACTIVE_TILE_ROWS = 32;
+const size_t ACTIVE_TILE_WORDS = 4;
+
+/* Rough costs, in nanoseconds, used to pick the engine
+ * of the next generation. */
+const size_t COUNTED_CELL_COST = 3;         // counting and advancing a cell
+const size_t BITSLICED_WORD_COST = 16;      // advancing a word of the alive mask
+const size_t INCREMENTAL_COUNT_COST = 1;    // updating a kept neighborhood count
+const size_t INCREMENTAL_VISIT_COST = 6;    // advancing a cell from its kept count
+
+/* Count of generations in a row which have to look cheaper to
+ * update incrementally before the counts of the whole board are
+ * set up, so that passing bursts of changes do not pay for it. */
+const size_t INCREMENTAL_WARMUP_GENERATIONS = 4;
+
+/* Count of the last generations whose hashes are kept to find
+ * repetitions; longer periods are not detected. */
+const size_t CYCLE_HISTORY_SIZE = 1024;
+
 const int START_CELLS_ALIVE = 150;
 const size_t BOARD_SIZE = 60;
 
 typedef std::set<int> conds_t;
 
-typedef int cell_t;
-typedef std::array<cell_t, BOARD_SIZE> row_t;
-typedef std::array<row_t, BOARD_SIZE> cells_t;
+typedef std::uint8_t cell_t;
+typedef Grid<cell_t> cells_t;
+
+typedef std::uint32_t count_t;
+
+/* Bit-packed plane with one bit per cell, set for state 1
+ * cells only. Bit (col % 64) of word (col / 64) in a row
+ * belongs to the cell in column col. */
+typedef std::uint64_t mask_word_t;
+typedef Grid<mask_word_t> mask_t;
+
+const size_t MASK_WORD_BITS = 64;
+
+/* Returns the count of mask words needed for a row of cells. */
+inline size_t getMaskWords(size_t width) {
+    return (width + MASK_WORD_BITS - 1) / MASK_WORD_BITS;
+}
+
+/* Returns the mask bit of a cell in a row of the mask. */
+inline bool isMaskBitSet(const mask_word_t *row, size_t col) {
+    return (row[col / MASK_WORD_BITS] >> (col % MASK_WORD_BITS)) & 1;
+}
+
+/* Fills the mask with bits of state 1 cells; the mask
+ * is resized to match the cells, if needed. */
+void fillAliveMask(const cells_t &cells, mask_t &mask);
+
+/* A cell changed by an update, with its state in
+ * the new generation. Fields have the same type, so
+ * a list of changes reads as an array of triples. */
+struct CellChange {
+    std::uint32_t row;
+    std::uint32_t col;
+    std::uint32_t state;
+};
+
+/* Counters and timings of the last update() or step() of a
+ * board, recorded once enabled. Transitions compare the cells
+ * before and after the whole call. Engines which count neighbors
+ * and apply rules in one pass (bit-sliced, tiled and incremental
+ * ones) report all their time as counting. */
+struct GenerationMetrics {
+    size_t generations = 0;         // generations advanced by the call
+    size_t births = 0;              // dead cells which became state 1
+    size_t deaths = 0;              // cells which became dead
+    size_t agings = 0;              // cells which moved to states above 1
+    size_t population = 0;          // state 1 cells after the call
+    size_t cellsSkipped = 0;        // cells left out as unable to change, summed over generations
+    double countSeconds = 0;        // counting neighbors
+    double transitionSeconds = 0;   // applying rules to the counts
+    double copySeconds = 0;         // halos of wrapped edges and copies of buffers
+    double totalSeconds = 0;        // the whole call
+};
+
+/* Statistics of the current generation of a board, kept up
+ * to date by updates once enabled. Live cells are cells in any
+ * state but dead; the bounding box covers rows [top, bottom)
+ * and columns [left, right), and is empty with the board. */
+struct BoardStats {
+    size_t liveCount = 0;               // cells in states other than 0
+    std::vector<size_t> histogram;      // count of cells in every state
+    size_t top = 0;
+    size_t left = 0;
+    size_t bottom = 0;
+    size_t right = 0;
+    double centroidRow = 0;             // mean row of live cells
+    double centroidCol = 0;             // mean column of live cells
+};
+
+/* Long-term behavior of a board, as far as it is known. */
+enum class Evolution {
+    RUNNING,    // no generation has repeated yet
+    EXTINCT,    // all cells are dead
+    STILL_LIFE, // generations repeat with period 1
+    PERIODIC    // generations repeat with a longer period
+};
+
+/* Behavior found by tracking cycles, with the count of
+ * generations between repetitions (1 for still and extinct
+ * boards) and the generation at which it was found. */
+struct CycleReport {
+    Evolution evolution = Evolution::RUNNING;
+    size_t period = 0;
+    size_t generation = 0;
+};
+
+class NeighborCounter;
+class BitSliceStepper;
+class ThreadPool;
+class TemporalBlocker;
+class IncrementalStepper;
+struct RowKernels;
+struct StatsDelta;
+
+/* Shapes of neighborhoods, as in LtL and HROT rules of Golly:
+ * cells within the radius r in both directions (Moore), within
+ * r steps along the axes (von Neumann), within the distance r+1/2
+ * (circular), with an odd sum of offsets (checkerboard), on the
+ * axes (cross), on the rows and columns next to the center (hash),
+ * or weighted by neighborhoodWeights (custom). */
+enum class NeighborhoodType {
+    MOORE,
+    VON_NEUMANN,
+    CIRCULAR,
+    CHECKERBOARD,
+    CROSS,
+    HASH,
+    CUSTOM
+};
 
 /* Helper structure for passing game rules
  * as arguments to the Board class constructor */
@@ -27,7 +160,82 @@ struct BoardArgs {
     conds_t surviveConds = conds_t(); // Ss
     conds_t birthConds = conds_t(); // Bb
     bool isIncludeCenter = false; // Mm
-    bool isMooreType = true; // Nn
+    NeighborhoodType neighborhoodType = NeighborhoodType::MOORE; // Nn
+    bool isMooreType = true; // former Nn, false turns the Moore type into von Neumann
+    std::vector<int> neighborhoodWeights; // custom weights of (2r+1)^2 cells, row by row
+    size_t width = BOARD_SIZE; // count of columns
+    size_t height = BOARD_SIZE; // count of rows
+    int threads = 1; // count of threads updating the board
+    bool isWrappedHorizontally = false; // left and right edges meet
+    bool isWrappedVertically = false; // top and bottom edges meet
+};
+
+
+/* Returns the type of the neighborhood given by boardArgs,
+ * which is von Neumann when the Moore type is turned off
+ * with isMooreType. */
+NeighborhoodType getNeighborhoodType(const BoardArgs &boardArgs);
+
+/* Returns the highest count of neighbors a cell
+ * can have in the neighborhood given by boardArgs. */
+count_t getNeighborhoodSize(const BoardArgs &boardArgs);
+
+/* Checks if the rules and the thread count given by
+ * boardArgs are logically correct. */
+void checkRuleArgsCorrect(const BoardArgs &boardArgs);
+
+
+/* Lookup tables of a RuleTable, in the form read by the
+ * row transition kernels. */
+struct TransitionView {
+    const std::uint8_t *conditionBits;  // readable up to 3 bytes past lastCount
+    count_t lastCount;                  // counts above share this entry
+    const cell_t *transitions;          // next state at (state << 2 | bits)
+    int states;                         // count of states
+};
+
+
+/* Birth and survival conditions compiled into dense lookup
+ * tables, so that the next state of a cell is found with two
+ * table reads and no branches. Tables are indexed by the count
+ * of state 1 cells in the whole neighborhood, center included;
+ * survival conditions are moved accordingly when the center
+ * does not count as a neighbor. */
+class RuleTable {
+
+    static const std::uint8_t BIRTH_BIT = 1;
+    static const std::uint8_t SURVIVAL_BIT = 2;
+
+    /* Condition bits met for each neighborhood count, followed
+     * by padding for 4-byte gathers; the entry at lastCount is
+     * shared by all counts above the largest condition. */
+    std::vector<std::uint8_t> conditionBits;
+    count_t lastCount = 0;
+
+    /* Next state for every pair of a state and condition bits,
+     * at index (state << 2 | bits). */
+    std::vector<cell_t> transitions;
+    int states = 0;
+
+public:
+
+    RuleTable() = default;
+
+    /* Compiles conditions and state count from boardArgs. */
+    explicit RuleTable(const BoardArgs &boardArgs);
+
+    /* Returns the state of a cell in the next generation, given
+     * the count of state 1 cells in its neighborhood, center
+     * included. */
+    cell_t next(cell_t state, count_t neighborhoodCount) const {
+        const std::uint8_t bits = conditionBits[neighborhoodCount < lastCount ? neighborhoodCount : lastCount];
+        return transitions[((size_t) state << 2) | bits];
+    }
+
+    /* Returns pointers to the tables for row kernels. */
+    TransitionView getView() const {
+        return {conditionBits.data(), lastCount, transitions.data(), states};
+    }
 };
 
 
@@ -36,8 +244,88 @@ struct BoardArgs {
 class Board {
 
     const BoardArgs args;   // arguments passed from the user
-    cells_t cells{};        // all cells in a board
-    cells_t snapshot{};     // snapshot of the board state
+    mutable cells_t cells{};        // all cells in a board (front buffer)
+    mutable bool isCellsOutdated = false;   // cells lag behind the alive mask
+    cells_t nextCells{};    // cells of the next generation (back buffer)
+    mask_t aliveMask{};     // state 1 cells of the current generation
+    mask_t nextAliveMask{}; // state 1 cells of the next generation
+    RuleTable rules;        // compiled birth and survival conditions
+    std::unique_ptr<ThreadPool> pool;           // threads updating bands of rows
+    std::unique_ptr<NeighborCounter> counter;   // engine counting neighbors
+    std::unique_ptr<BitSliceStepper> bitSlicer; // engine for two-state rules
+    std::unique_ptr<TemporalBlocker> blocker;   // engine for regions of active tiles
+    std::unique_ptr<IncrementalStepper> incremental;    // engine for few changes
+    const RowKernels *kernels = nullptr;        // vector kernels for this processor
+    Grid<count_t> neighbors;                    // neighbor counts of a row, per band
+
+    /* Boards wrapped around an axis are counted on a copy of the
+     * alive mask with a halo of r rows (or columns) on both sides,
+     * repeating cells of the opposite edge. Counting engines see a
+     * bounded board, so they need no wrapping of their own. */
+    size_t haloRows = 0;    // rows of the halo above and below
+    size_t haloCols = 0;    // columns of the halo on the left and right
+    mask_t wrappedMask;     // alive mask surrounded by the halo
+    mask_t wrappedNextMask; // next generation of the wrapped mask
+
+    /* Copy of the cells at a fixed address for views which have
+     * to outlive updates; refreshed by updates only while some
+     * view holds it. */
+    cells_t sharedCells;
+    size_t sharedCellsHolders = 0;
+
+    /* Cells changed by the last update or step, in row-major
+     * order, once recording has been enabled. The buffer keeps
+     * its capacity, so busy generations only allocate once. */
+    std::vector<CellChange> changes;
+    bool isChangesRecorded = false;
+    std::vector<CellChange> seedChanges;    // changes which set up the incremental engine
+    cells_t stepStartCells; // cells before a step, to find its changes and transitions
+    mask_t stepStartMask;   // alive mask before a step
+
+    /* Metrics of the last update or step, once recording has been
+     * enabled; otherwise no clock is read and nothing is counted. */
+    GenerationMetrics metrics;
+    bool isMetricsRecorded = false;
+    std::vector<double> bandSeconds;    // counting and transition time of every band
+
+    /* Statistics of the current generation, once enabled. Live
+     * cells are counted per row and per column, so that engines
+     * only adjust them for changed cells while they write the next
+     * generation, and the bounding box and the centroid are found
+     * from the counts instead of the cells. */
+    BoardStats stats;
+    bool isStatsRecorded = false;
+    std::vector<size_t> rowLiveCounts;
+    std::vector<size_t> colLiveCounts;  // per mask word for bit-sliced rules
+    size_t liveBitIndexSum = 0;         // sum of bit indices of live cells, for bit-sliced rules
+    std::vector<StatsDelta> statsDeltas;    // changes gathered by every band
+
+    size_t generation = 0;      // generations advanced since the start
+
+    /* Zobrist-style hash of the cells, once cycle tracking is
+     * enabled: a XOR of hashes of every 64-bit unit of a row (8
+     * cells, or a word of the alive mask for bit-sliced rules)
+     * with its position, so that updates rehash changed units
+     * only. Hashes of the last CYCLE_HISTORY_SIZE generations are
+     * kept, together with the generation they were last seen at,
+     * until a repetition is found. */
+    bool isCyclesTracked = false;
+    std::uint64_t boardHash = 0;
+    std::uint64_t emptyHash = 0;        // hash of a board with all cells dead
+    std::vector<std::uint64_t> hashHistory;     // hash of generation g at g % CYCLE_HISTORY_SIZE
+    std::unordered_map<std::uint64_t, size_t> hashGenerations;
+    CycleReport cycleReport;
+
+    /* Tiles of ACTIVE_TILE_ROWS rows and ACTIVE_TILE_WORDS mask
+     * words. A tile with no changes within the neighborhood radius
+     * in the last generation cannot change in the next one, so it
+     * is skipped; its back buffer already holds its current state. */
+    Grid<std::uint8_t> changedTiles;    // tiles changed by the last update
+    Grid<std::uint8_t> activeTiles;     // tiles recomputed by the last update
+    size_t activeTileCount = 0;
+    size_t activeWork = 0;              // rows times mask words of active tiles and their ghosts
+    bool isLastGenerationKept = false;  // back buffers of changed tiles hold the last generation
+    size_t cheapGenerations = 0;        // generations in a row cheaper to update incrementally
 
 public:
 
@@ -49,48 +337,238 @@ public:
 
     /* Creates Board with predefined start cell state, game
      * rules on each update are defined by the boardArgs
-     * argument. */
+     * argument. Dimensions of the start state have to match
+     * the width and height given in boardArgs. */
     Board(BoardArgs boardArgs, const cells_t &startState);
 
+    /* Restores Board from cells of a later generation, in any
+     * states below the state count, as saved after advancing
+     * 'startGeneration' generations from the start. */
+    Board(BoardArgs boardArgs, cells_t savedCells, size_t startGeneration);
+
+    Board(Board &&other) noexcept;
+
+    ~Board();
+
 
     /* Handles regular updates of the cell states,
-     * in accordance with game conditions. */
+     * in accordance with game conditions. Bands of rows are
+     * updated in parallel when more than one thread is set
+     * in the board arguments; the result does not depend
+     * on the count of threads. */
     void update();
 
+    /* Advances the board by 'generations' generations, with the
+     * same result as calling update() as many times. Changes,
+     * metrics and statistics cover the whole step, and shared
+     * cells are refreshed once at its end. */
+    void step(size_t generations);
+
     /* Returns const-reference to a 2-dimensional
-     * container with all cell values. */
+     * container with all cell values. The reference stays
+     * valid, but refers to the current generation only
+     * until the next call to update(). */
     const cells_t &getCells() const;
 
-    /* Returns the size of the board. */
+    /* Returns const-reference to a copy of the cells which stays at
+     * the same address for the lifetime of the board, and is kept
+     * equal to the current generation by every later update until
+     * each call is matched by releaseSharedCells(). Updates skip
+     * the copy while no caller holds it. */
+    const cells_t &acquireSharedCells();
+
+    /* Ends a hold taken by acquireSharedCells(). */
+    void releaseSharedCells();
+
+    /* Enables or disables recording of the cells changed
+     * by every update() and step(). Disabled by default. */
+    void recordChanges(bool isEnabled);
+
+    /* Returns the cells changed by the last update() or step(),
+     * with their new states; empty if recording is disabled.
+     * The reference stays valid, but its contents change with
+     * the next update. */
+    const std::vector<CellChange> &getChanges() const;
+
+    /* Enables or disables recording of metrics of every
+     * update() and step(). Disabled by default. */
+    void recordMetrics(bool isEnabled);
+
+    /* Returns the metrics of the last update() or step();
+     * all zero if recording is disabled. */
+    const GenerationMetrics &getMetrics() const;
+
+    /* Enables or disables statistics of the cells, kept up to
+     * date by every update() and step(). Disabled by default. */
+    void recordStats(bool isEnabled);
+
+    /* Returns the statistics of the current generation; all
+     * zero if they are disabled. Takes constant time. */
+    const BoardStats &getStats() const;
+
+    /* Enables or disables tracking of repeated generations. While
+     * enabled, each generation of update() and step() is compared.
+     * Disabled by default. */
+    void trackCycles(bool isEnabled);
+
+    /* Returns the behavior found since tracking was enabled. Once
+     * found, it stays the same, as the rules are deterministic.
+     * Repetitions are found by 64-bit hashes, and periods longer
+     * than CYCLE_HISTORY_SIZE are not found. */
+    const CycleReport &getCycleReport() const;
+
+    /* Returns the count of generations advanced since
+     * the board was created. */
+    size_t getGeneration() const;
+
+    /* Returns the arguments the board was created with. */
+    const BoardArgs &getArgs() const;
+
+    /* Returns const-reference to the bit-packed mask of
+     * state 1 cells of the current generation. */
+    const mask_t &getAliveMask() const;
+
+    /* Returns the size of the board (its width, which
+     * is equal to the height for square boards). */
     size_t getSize() const;
 
+    /* Returns the count of columns of the board. */
+    size_t getWidth() const;
+
+    /* Returns the count of rows of the board. */
+    size_t getHeight() const;
+
+    /* Returns the count of tiles the board is divided into
+     * for tracking changes. */
+    size_t getTileCount() const;
+
+    /* Returns the count of tiles recomputed by the last update;
+     * all of them, unless most of the board could change. */
+    size_t getActiveTileCount() const;
+
 private:
 
     /* Checks if arguments saved in 'args' variable are
-     * logically correct. */
-    void checkArgsCorrect() const;
+     * logically correct, and if the cells are dead or in
+     * state 1 only, unless 'isAnyStateAllowed' is set. */
+    void checkArgsCorrect(bool isAnyStateAllowed = false) const;
+
+    /* Creates the rule tables, neighbor counting engine
+     * and buffers matching the board arguments. */
+    void initUpdate();
+
+    /* Advances the board by a single generation. */
+    void advance();
+
+    /* Copies the current generation into the shared cells,
+     * while they are held. */
+    void refreshSharedCells();
+
+    /* Updates cells using the counting engine and rule tables. */
+    void updateCounted();
+
+    /* Updates the alive mask only, 64 cells at a time; cells
+     * are unpacked from the mask when they are requested. */
+    void updateBitSliced();
+
+    /* Updates the cells changed by the last generation and the
+     * neighborhoods of its flips only, from counts kept between
+     * generations. */
+    void updateIncremental();
+
+    /* Returns true if the incremental engine is expected to
+     * update the board faster than counting active tiles. */
+    bool isIncrementalCheaper() const;
+
+    /* Updates active tiles only, in runs of adjacent tiles. */
+    void updateActiveTiles();
+
+    /* Returns true if any edge of the board is wrapped. */
+    bool isWrapped() const;
+
+    /* Copies the alive mask into the wrapped mask, and
+     * refreshes its halo from the opposite edges. */
+    void fillWrappedMask();
+
+    /* Copies the inner part of the next wrapped mask into
+     * the next alive mask, gathering changes of statistics. */
+    void readWrappedMask();
+
+    /* Marks tiles close enough to changed tiles as active.
+     * Returns false, with all tiles marked, if updating active
+     * tiles only would not save much work. */
+    bool findActiveTiles();
+
+    /* Marks active tiles which differ from the last generation. */
+    void findChangedTiles();
+
+    /* Lists cells which differ from 'lastCells' (or from
+     * 'lastMask' for bit-sliced rules) in 'found'. Only tiles
+     * marked as changed are compared, unless 'isEveryTile'. */
+    void findChanges(const cells_t &lastCells, const mask_t &lastMask, bool isEveryTile,
+                     std::vector<CellChange> &found);
+
+    /* Adds the transitions of cells which differ from 'lastCells'
+     * (or from 'lastMask' for bit-sliced rules) to the metrics,
+     * together with the population. Only tiles marked as changed
+     * are compared, unless 'isEveryTile'. */
+    void findTransitions(const cells_t &lastCells, const mask_t &lastMask, bool isEveryTile);
+
+    /* Counts the statistics of the current generation
+     * over the whole board. */
+    void countStats();
+
+    /* Returns the changes of the statistics gathered by a band,
+     * or null if statistics are disabled. */
+    StatsDelta *getStatsDelta(size_t band);
+
+    /* Adds the changes gathered by the bands since the last call
+     * to the statistics, and clears them. */
+    void mergeStats();
+
+    /* Finds the count of live cells, the bounding box and the
+     * centroid from the histogram and the counts of live cells. */
+    void finishStats();
+
+    /* Returns a 64-bit unit of a row of the cells (zero-padded
+     * at the end of the row), or of the alive mask for bit-sliced
+     * rules, whose cells lag behind the mask. */
+    std::uint64_t getUnitBits(const cells_t &unitCells, const mask_t &unitMask, size_t row, size_t unit) const;
+
+    /* Returns the hash of a unit holding 'bits' at its position. */
+    std::uint64_t getUnitHash(size_t row, size_t unit, std::uint64_t bits) const;
+
+    /* Returns the count of 64-bit units hashed in every row. */
+    size_t getHashUnits() const;
+
+    /* Hashes the whole board, and forgets all hashes kept before. */
+    void countHash();
+
+    /* Rehashes units which differ from 'lastCells' (or from
+     * 'lastMask' for bit-sliced rules), in tiles marked as
+     * changed only, and looks for the hash among the kept ones. */
+    void updateHash(const cells_t &lastCells, const mask_t &lastMask);
+
+    /* Looks for the hash of the current generation among the
+     * kept ones, and keeps it. */
+    void recordHash();
 
-    /* Tests birth conditions for a dead cell (returns true if
-     * the conditions are met and false otherwise). For a fully
-     * or partially alive cell, false is returned. */
-    bool testBirthConditions(size_t row, size_t col) const;
+    /* Returns true if all cells are dead. */
+    bool isBoardEmpty() const;
 
-    /* Tests survival conditions for a fully alive cell (returns true if
-     * the conditions are met and false otherwise). For a dead
-     * or partially alive cell, false is returned. */
-    bool testSurvivalConditions(size_t row, size_t col) const;
+    /* Returns the count of cells in active tiles. */
+    size_t getActiveCellCount() const;
 
-    /* Tests any conditions for neighbor count. */
-    bool testConditions(size_t row, size_t col, const conds_t &conds) const;
+    /* Marks all tiles as changed, when changes are not known. */
+    void markAllTilesChanged();
 
-    /* Returns count of neighbors (state 1 cells)
-     * in a row relative to the center point. */
-    int getNeighborsInRow(size_t centerRow, size_t centerCol, int offset) const;
+    /* Rewrites cells from the alive mask, if it is newer. */
+    void syncCells() const;
 
     /* Fills the container passed as an argument
      * with random cells designated to become alive.
      * The count of cells is defined by an appropriate
      * argument from 'args' variable. */
-    void getRandomStartCells(std::set<cell_t> &cellSet) const;
+    void getRandomStartCells(std::set<size_t> &cellSet) const;
 };
 
@@ -0,0 +1,271 @@
+#include "checkpoint.hpp"
+#include <stdexcept>
+#include <system_error>
+#include <algorithm>
+#include <limits>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Marks files written by saveCheckpoint(). */
+const std::uint64_t CHECKPOINT_MAGIC = 0x4c744c436b707400ULL;   // "LtLCkpt"
+
+/* Count of bytes of the header of a checkpoint. */
+const size_t CHECKPOINT_HEADER_BYTES = 80;
+
+/* Bits of the flags field of the header. */
+const std::uint32_t CHECKPOINT_INCLUDE_CENTER = 1;
+const std::uint32_t CHECKPOINT_WRAPPED_HORIZONTALLY = 2;
+const std::uint32_t CHECKPOINT_WRAPPED_VERTICALLY = 4;
+
+/* Appends the lowest 'size' bytes of 'value', lowest first. */
+inline void appendUint(std::string &bytes, std::uint64_t value, size_t size) {
+    for (size_t byte = 0; byte < size; ++byte)
+        bytes.push_back((char) (value >> (8 * byte)));
+}
+
+/* Reads a number of 'size' bytes, lowest first, and moves
+ * the cursor past it. */
+inline std::uint64_t takeUint(const unsigned char *&cursor, const unsigned char *end, size_t size) {
+    if ((size_t) (end - cursor) < size)
+        throw std::invalid_argument("Checkpoint file is truncated");
+    std::uint64_t value = 0;
+    for (size_t byte = 0; byte < size; ++byte)
+        value |= (std::uint64_t) cursor[byte] << (8 * byte);
+    cursor += size;
+    return value;
+}
+
+/* Returns the header of a checkpoint of the board, with
+ * 'cellBytes' bytes of compressed cells. */
+std::string getCheckpointHeader(const Board &board, std::uint64_t cellBytes) {
+    const BoardArgs &args = board.getArgs();
+    std::uint32_t flags = 0;
+    if (args.isIncludeCenter)
+        flags |= CHECKPOINT_INCLUDE_CENTER;
+    if (args.isWrappedHorizontally)
+        flags |= CHECKPOINT_WRAPPED_HORIZONTALLY;
+    if (args.isWrappedVertically)
+        flags |= CHECKPOINT_WRAPPED_VERTICALLY;
+
+    std::string header;
+    appendUint(header, CHECKPOINT_MAGIC, 8);
+    appendUint(header, CHECKPOINT_VERSION, 4);
+    appendUint(header, flags, 4);
+    appendUint(header, (std::uint32_t) args.neighborhoodRadius, 4);
+    appendUint(header, (std::uint32_t) args.states, 4);
+    appendUint(header, (std::uint32_t) getNeighborhoodType(args), 4);
+    appendUint(header, (std::uint32_t) args.threads, 4);
+    appendUint(header, args.width, 8);
+    appendUint(header, args.height, 8);
+    appendUint(header, board.getGeneration(), 8);
+    appendUint(header, args.surviveConds.size(), 4);
+    appendUint(header, args.birthConds.size(), 4);
+    appendUint(header, args.neighborhoodWeights.size(), 4);
+    appendUint(header, 0, 4);   // reserved
+    appendUint(header, cellBytes, 8);
+    return header;
+}
+
+/* Writes all bytes of 'bytes' to the descriptor. */
+void writeBytes(int descriptor, const std::string &bytes, const std::string &path) {
+    size_t written = 0;
+    while (written < bytes.size()) {
+        const ssize_t count = write(descriptor, bytes.data() + written, bytes.size() - written);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            throw std::system_error(errno, std::generic_category(), "Cannot write checkpoint " + path);
+        written += (size_t) count;
+    }
+}
+
+/* Writes the sections of a checkpoint of the board after the
+ * header, and then the header, to the open descriptor. */
+void writeCheckpoint(int descriptor, const Board &board, const std::string &path) {
+    const BoardArgs &args = board.getArgs();
+    std::string bytes = getCheckpointHeader(board, 0);
+    for (const int cond : args.surviveConds)
+        appendUint(bytes, (std::uint32_t) cond, 4);
+    for (const int cond : args.birthConds)
+        appendUint(bytes, (std::uint32_t) cond, 4);
+    for (const int weight : args.neighborhoodWeights)
+        appendUint(bytes, (std::uint8_t) weight, 1);
+    writeBytes(descriptor, bytes, path);
+
+    bytes.clear();
+    bytes.reserve(CHECKPOINT_BUFFER_BYTES + 16);
+    std::uint64_t cellBytes = 0;
+    const auto appendRun = [&](std::uint64_t length, cell_t state) {
+        for (; length >= 0x80; length >>= 7)
+            bytes.push_back((char) ((length & 0x7f) | 0x80));
+        bytes.push_back((char) length);
+        bytes.push_back((char) state);
+        if (bytes.size() >= CHECKPOINT_BUFFER_BYTES) {
+            writeBytes(descriptor, bytes, path);
+            cellBytes += bytes.size();
+            bytes.clear();
+        }
+    };
+
+    const cells_t &cells = board.getCells();
+    cell_t runState = cells[0][0];
+    std::uint64_t runLength = 0;
+    for (size_t row = 0; row < cells.getHeight(); ++row) {
+        const cell_t *rowCells = cells[row];
+        for (size_t col = 0; col < cells.getWidth(); ++col) {
+            if (rowCells[col] == runState) {
+                ++runLength;
+                continue;
+            }
+            appendRun(runLength, runState);
+            runState = rowCells[col];
+            runLength = 1;
+        }
+    }
+    appendRun(runLength, runState);
+    writeBytes(descriptor, bytes, path);
+    cellBytes += bytes.size();
+
+    const std::string header = getCheckpointHeader(board, cellBytes);
+    if (pwrite(descriptor, header.data(), header.size(), 0) != (ssize_t) header.size())
+        throw std::system_error(errno, std::generic_category(), "Cannot write checkpoint " + path);
+}
+
+/* Decodes the sections of a checkpoint mapped at 'data'
+ * into the arguments, cells and generation of a board. */
+void readCheckpoint(const unsigned char *data, size_t size,
+                    BoardArgs &args, cells_t &cells, size_t &generation) {
+    const unsigned char *cursor = data, *end = data + size;
+    if (takeUint(cursor, end, 8) != CHECKPOINT_MAGIC)
+        throw std::invalid_argument("File does not hold a board checkpoint");
+    if (takeUint(cursor, end, 4) != CHECKPOINT_VERSION)
+        throw std::invalid_argument("Checkpoint version is not supported");
+
+    const std::uint64_t flags = takeUint(cursor, end, 4);
+    args.isIncludeCenter = (flags & CHECKPOINT_INCLUDE_CENTER) != 0;
+    args.isWrappedHorizontally = (flags & CHECKPOINT_WRAPPED_HORIZONTALLY) != 0;
+    args.isWrappedVertically = (flags & CHECKPOINT_WRAPPED_VERTICALLY) != 0;
+    args.neighborhoodRadius = (int) (std::int32_t) takeUint(cursor, end, 4);
+    args.states = (int) (std::int32_t) takeUint(cursor, end, 4);
+    const std::uint64_t type = takeUint(cursor, end, 4);
+    if (type > (std::uint64_t) NeighborhoodType::CUSTOM)
+        throw std::invalid_argument("Checkpoint neighborhood type is not supported");
+    args.neighborhoodType = (NeighborhoodType) type;
+    args.threads = (int) (std::int32_t) takeUint(cursor, end, 4);
+    args.width = (size_t) takeUint(cursor, end, 8);
+    args.height = (size_t) takeUint(cursor, end, 8);
+    generation = (size_t) takeUint(cursor, end, 8);
+    const std::uint64_t surviveCount = takeUint(cursor, end, 4);
+    const std::uint64_t birthCount = takeUint(cursor, end, 4);
+    const std::uint64_t weightCount = takeUint(cursor, end, 4);
+    takeUint(cursor, end, 4);   // reserved
+    const std::uint64_t cellBytes = takeUint(cursor, end, 8);
+
+    args.surviveConds.clear();
+    for (std::uint64_t cond = 0; cond < surviveCount; ++cond)
+        args.surviveConds.insert((int) (std::int32_t) takeUint(cursor, end, 4));
+    args.birthConds.clear();
+    for (std::uint64_t cond = 0; cond < birthCount; ++cond)
+        args.birthConds.insert((int) (std::int32_t) takeUint(cursor, end, 4));
+    args.neighborhoodWeights.clear();
+    for (std::uint64_t weight = 0; weight < weightCount; ++weight)
+        args.neighborhoodWeights.push_back((int) takeUint(cursor, end, 1));
+
+    if (args.width == 0 || args.height == 0 || args.width > std::numeric_limits<size_t>::max() / args.height)
+        throw std::invalid_argument("Checkpoint board dimensions are not correct");
+    if (cellBytes != (std::uint64_t) (end - cursor))
+        throw std::invalid_argument("Checkpoint file is truncated");
+
+    cells = cells_t(args.height, args.width);
+    size_t row = 0, col = 0;
+    std::uint64_t remaining = (std::uint64_t) args.width * args.height;
+    while (remaining > 0) {
+        std::uint64_t length = 0;
+        for (int shift = 0;; shift += 7) {
+            const std::uint64_t byte = takeUint(cursor, end, 1);
+            if (shift > 63)
+                throw std::invalid_argument("Checkpoint run length is not correct");
+            length |= (byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                break;
+        }
+        const cell_t state = (cell_t) takeUint(cursor, end, 1);
+        if (length == 0 || length > remaining)
+            throw std::invalid_argument("Checkpoint run length is not correct");
+        remaining -= length;
+
+        // runs go on over the ends of rows
+        while (length > 0) {
+            const size_t count = (size_t) std::min<std::uint64_t>(length, args.width - col);
+            std::fill(cells[row] + col, cells[row] + col + count, state);
+            length -= count;
+            col += count;
+            if (col == args.width) {
+                col = 0;
+                ++row;
+            }
+        }
+    }
+    if (cursor != end)
+        throw std::invalid_argument("Checkpoint holds more cells than its board");
+}
+
+
+void saveCheckpoint(const Board &board, const std::string &path) {
+    const std::string temporaryPath = path + ".tmp";
+    const int descriptor = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0)
+        throw std::system_error(errno, std::generic_category(), "Cannot create checkpoint " + temporaryPath);
+
+    try {
+        writeCheckpoint(descriptor, board, temporaryPath);
+        if (fsync(descriptor) != 0)
+            throw std::system_error(errno, std::generic_category(), "Cannot write checkpoint " + temporaryPath);
+    } catch (...) {
+        close(descriptor);
+        unlink(temporaryPath.c_str());
+        throw;
+    }
+    close(descriptor);
+
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        const int error = errno;
+        unlink(temporaryPath.c_str());
+        throw std::system_error(error, std::generic_category(), "Cannot replace checkpoint " + path);
+    }
+}
+
+Board loadCheckpoint(const std::string &path) {
+    const int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+        throw std::system_error(errno, std::generic_category(), "Cannot open checkpoint " + path);
+
+    struct stat status{};
+    if (fstat(descriptor, &status) != 0 || (size_t) status.st_size < CHECKPOINT_HEADER_BYTES) {
+        close(descriptor);
+        throw std::invalid_argument("File " + path + " does not hold a board checkpoint");
+    }
+    const size_t bytes = (size_t) status.st_size;
+    void *memory = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    const int error = errno;
+    close(descriptor);
+    if (memory == MAP_FAILED)
+        throw std::system_error(error, std::generic_category(), "Cannot map checkpoint " + path);
+    madvise(memory, bytes, MADV_SEQUENTIAL);
+
+    BoardArgs args;
+    cells_t cells;
+    size_t generation = 0;
+    try {
+        readCheckpoint(static_cast<const unsigned char *>(memory), bytes, args, cells, generation);
+    } catch (...) {
+        munmap(memory, bytes);
+        throw;
+    }
+    munmap(memory, bytes);
+    return Board(std::move(args), std::move(cells), generation);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "board.hpp"
+
+/* Version of the checkpoint format written by saveCheckpoint();
+ * files of other versions are rejected when loaded. */
+const std::uint32_t CHECKPOINT_VERSION = 1;
+
+/* Size of the buffer compressed cells are written through. */
+const size_t CHECKPOINT_BUFFER_BYTES = 1 << 20;
+
+/* Checkpoint files hold, in little-endian order:
+ *  - a header with a magic number, the version, the board
+ *    arguments, the generation and the sizes of the sections,
+ *  - survival and birth conditions, as 32-bit integers,
+ *  - weights of a custom neighborhood, a byte each,
+ *  - cells in row-major order, compressed as runs of equal
+ *    states: the length of a run as a LEB128 number, then the
+ *    state. Runs go on over the ends of rows, so empty areas
+ *    of any size take a few bytes. */
+
+/* Writes the arguments, generation and cells of the board to
+ * the file at 'path'. The file is written under a temporary
+ * name and renamed, so an earlier checkpoint at 'path' is kept
+ * whole if writing fails. */
+void saveCheckpoint(const Board &board, const std::string &path);
+
+/* Restores a board written by saveCheckpoint(). The file is
+ * mapped into memory and cells are decoded straight from it,
+ * so large boards are not read through extra buffers. */
+Board loadCheckpoint(const std::string &path);
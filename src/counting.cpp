@@ -0,0 +1,356 @@
+#include "counting.hpp"
+#include "stats.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+
+/* ---------- Helpers for calculating offset ---------- */
+
+inline bool isCorrectOffset(size_t coord, int offset) {
+    return (offset > -1 || coord >= (size_t) (-offset));
+}
+
+inline size_t addOffset(size_t coord, int offset) {
+    if (offset < 0) {
+        if (coord < (size_t) (-offset))
+            throw std::invalid_argument("Negative offset greater than coordinate");
+
+        return coord - (size_t) (-offset);
+    }
+    return coord + (size_t) offset;
+}
+
+/* --------------------------------------------------- */
+
+/* Prefix sums are built by every band of rows as if the band
+ * started the board; this adds the sums of the rows above each
+ * band afterwards. Row i+1 of the sums ends at row i of cells,
+ * and addCarry(row, carryRow) has to add the sums of row
+ * 'carryRow' to the sums of a row below it. */
+template<typename AddCarry>
+void carryBandSums(ThreadPool *pool, size_t rows, AddCarry addCarry) {
+    const size_t bands = getBandCount(pool, rows);
+    if (bands < 2) return;
+
+    // last rows of the bands, one after another...
+    for (size_t band = 1; band < bands; ++band)
+        addCarry(getBandStart(rows, bands, band + 1), getBandStart(rows, bands, band));
+
+    // ...then the other rows of all bands at once
+    forEachBand(pool, rows, [&](size_t band, size_t first, size_t last) {
+        if (band == 0) return;
+        for (size_t row = first + 1; row < last; ++row)
+            addCarry(row, first);
+    });
+}
+
+RowScanCounter::RowScanCounter(const BoardArgs &boardArgs)
+        : radius(boardArgs.neighborhoodRadius),
+          shape(boardArgs) {}
+
+void RowScanCounter::prepare(const mask_t &aliveMask, size_t boardWidth) {
+    alive = &aliveMask;
+    width = boardWidth;
+}
+
+void RowScanCounter::countRow(size_t row, count_t *out) const {
+    for (size_t col = 0; col < width; ++col) {
+        int neighbors = 0;
+        for (int offset = -radius; offset <= radius; ++offset) {
+            if (isCorrectOffset(row, offset))
+                neighbors += getNeighborsInRow(row, col, offset);
+        }
+        out[col] = (count_t) neighbors;
+    }
+}
+
+int RowScanCounter::getNeighborsInRow(size_t centerRow, size_t centerCol, int offset) const {
+    auto row = addOffset(centerRow, offset);
+    if (row >= alive->getHeight())
+        return 0; // no neighbors in a non-existent row
+
+    const mask_word_t *rowMask = (*alive)[row];
+    int count = 0;
+
+    for (int i = -radius; i <= radius; ++i) {
+        const count_t weight = shape.getWeight(offset, i);
+        if (weight && (i > -1 || centerCol >= (size_t) (-i))) {
+            auto col = addOffset(centerCol, i);
+            if (col < width
+                && isMaskBitSet(rowMask, col)) {
+                    count += (int) weight; // neighbor cell found
+            }
+        }
+
+    }
+
+    return count;
+}
+
+
+BoxSumCounter::BoxSumCounter(const BoardArgs &boardArgs, ThreadPool *threadPool)
+        : radius(boardArgs.neighborhoodRadius),
+          kernels(getRowKernels()),
+          pool(threadPool) {}
+
+void BoxSumCounter::prepare(const mask_t &aliveMask, size_t boardWidth) {
+    alive = &aliveMask;
+    width = boardWidth;
+    const size_t height = alive->getHeight();
+    if (sums.getHeight() != height + 1 || sums.getWidth() != width + 1)
+        sums = Grid<count_t>(height + 1, width + 1); // first row and column stay zero
+
+    forEachBand(pool, height, [&](size_t, size_t first, size_t last) {
+        for (size_t row = first; row < last; ++row) {
+            const mask_word_t *rowMask = (*alive)[row];
+            const count_t *above = sums[row == first ? 0 : row];
+            count_t *current = sums[row + 1];
+
+            count_t rowSum = 0;
+            for (size_t col = 0; col < width; ++col) {
+                rowSum += isMaskBitSet(rowMask, col);
+                current[col + 1] = above[col + 1] + rowSum;
+            }
+        }
+    });
+
+    carryBandSums(pool, height, [&](size_t row, size_t carryRow) {
+        count_t *current = sums[row];
+        const count_t *carry = sums[carryRow];
+        for (size_t col = 1; col <= width; ++col)
+            current[col] += carry[col];
+    });
+}
+
+void BoxSumCounter::countRow(size_t row, count_t *out) const {
+    const size_t height = alive->getHeight();
+    const size_t r = (size_t) radius;
+
+    // Rows of the neighborhood, clipped to the board edges
+    const count_t *top = sums[row < r ? 0 : row - r];
+    const count_t *bottom = sums[std::min(row + r + 1, height)];
+
+    // Columns of the box fit in the board between these two
+    const size_t firstInner = std::min(r, width);
+    const size_t lastInner = std::max(firstInner, width < r ? 0 : width - r);
+
+    auto countClipped = [&](size_t col) {
+        const size_t left = (col < r ? 0 : col - r);
+        const size_t right = std::min(col + r + 1, width);
+        out[col] = bottom[right] - top[right] - bottom[left] + top[left];
+    };
+
+    for (size_t col = 0; col < firstInner; ++col)
+        countClipped(col);
+    kernels.combineRows(bottom + firstInner + r + 1, top + firstInner + r + 1,
+                        bottom + firstInner - r, top + firstInner - r,
+                        out + firstInner, lastInner - firstInner);
+    for (size_t col = lastInner; col < width; ++col)
+        countClipped(col);
+}
+
+
+DiamondCounter::DiamondCounter(const BoardArgs &boardArgs, ThreadPool *threadPool)
+        : radius(boardArgs.neighborhoodRadius),
+          kernels(getRowKernels()),
+          pool(threadPool) {}
+
+void DiamondCounter::prepare(const mask_t &aliveMask, size_t boardWidth) {
+    alive = &aliveMask;
+    width = boardWidth;
+    const size_t height = alive->getHeight();
+    if (diagonalSums.getHeight() != height + 1 || diagonalSums.getWidth() != width + 2) {
+        diagonalSums = Grid<count_t>(height + 1, width + 2);
+        antiDiagonalSums = Grid<count_t>(height + 1, width + 2);
+    }
+
+    forEachBand(pool, height, [&](size_t, size_t first, size_t last) {
+        for (size_t row = first; row < last; ++row) {
+            const mask_word_t *rowMask = (*alive)[row];
+            const count_t *diagonalAbove = diagonalSums[row == first ? 0 : row];
+            const count_t *antiDiagonalAbove = antiDiagonalSums[row == first ? 0 : row];
+            count_t *diagonal = diagonalSums[row + 1];
+            count_t *antiDiagonal = antiDiagonalSums[row + 1];
+
+            for (size_t col = 0; col < width; ++col) {
+                const count_t isAlive = isMaskBitSet(rowMask, col);
+                diagonal[col + 1] = diagonalAbove[col] + isAlive;
+                antiDiagonal[col + 1] = antiDiagonalAbove[col + 2] + isAlive;
+            }
+        }
+    });
+
+    // Diagonals continue from the row above the band, 'rise'
+    // columns away from where they end in a row of the band
+    carryBandSums(pool, height, [&](size_t row, size_t carryRow) {
+        const size_t rise = row - carryRow;
+        count_t *diagonal = diagonalSums[row];
+        count_t *antiDiagonal = antiDiagonalSums[row];
+        const count_t *diagonalCarry = diagonalSums[carryRow];
+        const count_t *antiDiagonalCarry = antiDiagonalSums[carryRow];
+        for (size_t col = rise + 1; col <= width; ++col)
+            diagonal[col] += diagonalCarry[col - rise];
+        for (size_t col = 1; col + rise <= width; ++col)
+            antiDiagonal[col] += antiDiagonalCarry[col + rise];
+    });
+}
+
+count_t DiamondCounter::sumDiagonal(long row, long col, long length) const {
+    const long height = (long) alive->getHeight();
+    const long first = std::max({0L, -row, -col});
+    const long last = std::min({length - 1, height - 1 - row, (long) width - 1 - col});
+    if (first > last) return 0;
+
+    return diagonalSums[row + last + 1][col + last + 1]
+         - diagonalSums[row + first][col + first];
+}
+
+count_t DiamondCounter::sumAntiDiagonal(long row, long col, long length) const {
+    const long height = (long) alive->getHeight();
+    const long first = std::max({0L, -row, col - ((long) width - 1)});
+    const long last = std::min({length - 1, height - 1 - row, col});
+    if (first > last) return 0;
+
+    return antiDiagonalSums[row + last + 1][col - last + 1]
+         - antiDiagonalSums[row + first][col - first + 2];
+}
+
+void DiamondCounter::countRow(size_t row, count_t *out) const {
+    const long r = radius;
+    const long center = (long) row;
+    const long height = (long) alive->getHeight();
+
+    // Diamonds centered in these columns of an inner row need no
+    // clipping, so their edges are read straight from the sums
+    long firstInner = (long) width, lastInner = (long) width;
+    if (center >= r && center + r < height && (long) width > 2 * r + 1) {
+        firstInner = r + 1;
+        lastInner = (long) width - r;
+    }
+
+    // A diamond centered r+1 columns left of the board holds no cells
+    count_t count = 0;
+    auto slideClipped = [&](long col) {
+        // right edge of the diamond centered at col
+        count += sumDiagonal(center - r, col, r + 1) + sumAntiDiagonal(center + 1, col + r - 1, r);
+        // left edge of the diamond centered at col-1
+        count -= sumAntiDiagonal(center - r, col - 1, r + 1) + sumDiagonal(center + 1, col - r, r);
+        if (col >= 0)
+            out[col] = count;
+    };
+
+    for (long col = -r; col < firstInner; ++col)
+        slideClipped(col);
+
+    if (firstInner < lastInner) {
+        // Differences between consecutive diamonds, summed up afterwards
+        const size_t first = (size_t) firstInner, length = (size_t) (lastInner - firstInner);
+        const size_t top = (size_t) (center - r), middle = (size_t) center + 1, bottom = (size_t) (center + r + 1);
+        const size_t ur = (size_t) r;
+        kernels.combineRows(diagonalSums[middle] + first + ur + 1, diagonalSums[top] + first,
+                            diagonalSums[bottom] + first, diagonalSums[middle] + first - ur,
+                            out + first, length);
+        kernels.accumulateRows(antiDiagonalSums[bottom] + first + 1, antiDiagonalSums[middle] + first + ur + 1,
+                               antiDiagonalSums[middle] + first - ur, antiDiagonalSums[top] + first + 1,
+                               out + first, length);
+        for (long col = firstInner; col < lastInner; ++col) {
+            count += out[col];
+            out[col] = count;
+        }
+    }
+
+    for (long col = lastInner; col < (long) width; ++col)
+        slideClipped(col);
+}
+
+
+SpanCounter::SpanCounter(const BoardArgs &boardArgs, ThreadPool *threadPool)
+        : radius(boardArgs.neighborhoodRadius),
+          shape(boardArgs),
+          isStepped(shape.hasSteppedSpans()),
+          kernels(getRowKernels()),
+          pool(threadPool) {}
+
+void SpanCounter::prepare(const mask_t &aliveMask, size_t boardWidth) {
+    alive = &aliveMask;
+    width = boardWidth;
+    const size_t height = alive->getHeight();
+    const size_t r = (size_t) radius;
+    const size_t paddedWidth = width + 2 * r + 2;
+    if (rowSums.getHeight() != height || rowSums.getWidth() != paddedWidth) {
+        rowSums = Grid<count_t>(height, paddedWidth); // padding stays zero on the left
+        steppedSums = Grid<count_t>(isStepped ? height : 0, paddedWidth);
+    }
+
+    forEachBand(pool, height, [&](size_t, size_t first, size_t last) {
+        for (size_t row = first; row < last; ++row) {
+            const mask_word_t *rowMask = (*alive)[row];
+            count_t *sums = rowSums[row];
+            for (size_t col = 0; col < width; ++col)
+                sums[col + r + 1] = sums[col + r] + isMaskBitSet(rowMask, col);
+            std::fill(sums + width + r + 1, sums + paddedWidth, sums[width + r]);
+
+            if (!isStepped) continue;
+            count_t *stepped = steppedSums[row];
+            for (size_t col = 0; col < width; ++col)
+                stepped[col + r + 2] = stepped[col + r] + isMaskBitSet(rowMask, col);
+            for (size_t col = width + r + 2; col < paddedWidth; ++col)
+                stepped[col] = stepped[col - 2];
+        }
+    });
+}
+
+void SpanCounter::countRow(size_t row, count_t *out) const {
+    const long height = (long) alive->getHeight();
+    const long r = radius;
+    std::fill(out, out + width, 0);
+
+    // spans of weight 1 are added two at a time by the row kernels
+    const count_t *pendingEnd = nullptr, *pendingBegin = nullptr;
+    for (const NeighborhoodSpan &span : shape.getSpans()) {
+        const long target = (long) row + span.rowOffset;
+        if (target < 0 || target >= height) continue;
+
+        // sums of the span centered in column 0, in padded columns
+        const Grid<count_t> &sums = span.step == 2 ? steppedSums : rowSums;
+        const count_t *end = sums[(size_t) target] + (span.lastCol + r + span.step);
+        const count_t *begin = sums[(size_t) target] + (span.firstCol + r);
+        if (span.weight != 1) {
+            const count_t weight = span.weight;
+            for (size_t col = 0; col < width; ++col)
+                out[col] += weight * (end[col] - begin[col]);
+        } else if (pendingEnd) {
+            kernels.accumulateRows(end, begin, pendingBegin, pendingEnd, out, width);
+            pendingEnd = nullptr;
+        } else {
+            pendingEnd = end;
+            pendingBegin = begin;
+        }
+    }
+    if (pendingEnd)
+        kernels.accumulateRows(pendingEnd, pendingBegin, pendingEnd, pendingEnd, out, width);
+}
+
+
+void advanceRows(const NeighborCounter &counter, const RowKernels &kernels, const TransitionView &rules,
+                 const cells_t &cells, cells_t &nextCells, mask_t &nextAlive,
+                 size_t first, size_t last, count_t *neighbors,
+                 size_t haloRows, size_t haloCols, StatsDelta *delta) {
+    for (size_t row = first; row < last; ++row) {
+        counter.countRow(row + haloRows, neighbors);
+        kernels.transitionRow(rules, cells[row], neighbors + haloCols, nextCells[row], nextAlive[row], cells.getWidth());
+        // both rows are still in the cache
+        if (delta)
+            addCellsDelta(cells[row], nextCells[row], row, 0, cells.getWidth(), *delta);
+    }
+}
+
+
+std::unique_ptr<NeighborCounter> makeNeighborCounter(const BoardArgs &boardArgs, ThreadPool *threadPool) {
+    const NeighborhoodType type = getNeighborhoodType(boardArgs);
+    if (type == NeighborhoodType::MOORE)
+        return std::make_unique<BoxSumCounter>(boardArgs, threadPool);
+    if (type == NeighborhoodType::VON_NEUMANN)
+        return std::make_unique<DiamondCounter>(boardArgs, threadPool);
+    return std::make_unique<SpanCounter>(boardArgs, threadPool);
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "board.hpp"
+#include "neighborhood.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+/* Interface of engines calculating the count of state 1 cells
+ * in the neighborhood of every cell of a board. Counts include
+ * the center cell itself; RuleTable accounts for it. */
+class NeighborCounter {
+public:
+    virtual ~NeighborCounter() = default;
+
+    /* Builds helper structures for a single generation from
+     * the mask of state 1 cells of a board 'width' cells wide.
+     * The mask has to stay unchanged and alive until the next
+     * call to prepare(). */
+    virtual void prepare(const mask_t &alive, size_t width) = 0;
+
+    /* Writes neighborhood counts of all cells in a row to
+     * 'out', which has to hold at least as many elements as
+     * the board width. Rows can be counted concurrently. */
+    virtual void countRow(size_t row, count_t *out) const = 0;
+};
+
+
+/* Counts neighbors by scanning the neighborhood cell by cell.
+ * Works for any neighborhood type, in O(r^2) per cell. */
+class RowScanCounter : public NeighborCounter {
+
+    const int radius;
+    const NeighborhoodShape shape;
+    const mask_t *alive = nullptr;
+    size_t width = 0;
+
+public:
+
+    explicit RowScanCounter(const BoardArgs &boardArgs);
+
+    void prepare(const mask_t &alive, size_t width) override;
+
+    void countRow(size_t row, count_t *out) const override;
+
+private:
+
+    /* Returns weighted count of state 1 cells in a row
+     * of the neighborhood relative to the center point. */
+    int getNeighborsInRow(size_t centerRow, size_t centerCol, int offset) const;
+};
+
+
+/* Counts neighbors in a Moore neighborhood with a summed-area
+ * table (integral image) of state 1 cells, built once per
+ * generation. Every count takes constant time regardless
+ * of the neighborhood radius. */
+class BoxSumCounter : public NeighborCounter {
+
+    const int radius;
+    const RowKernels &kernels;
+    ThreadPool *pool;
+    const mask_t *alive = nullptr;
+    size_t width = 0;
+
+    /* sums[i][j] holds the count of state 1 cells in rows < i
+     * and columns < j. Values wrap around modulo 2^32 on huge
+     * boards, which keeps every box difference exact as long
+     * as the box itself holds less than 2^32 cells. */
+    Grid<count_t> sums;
+
+public:
+
+    /* Prefix sums are built by the threads of 'threadPool',
+     * or by the calling thread only, if it is null. */
+    explicit BoxSumCounter(const BoardArgs &boardArgs, ThreadPool *threadPool = nullptr);
+
+    void prepare(const mask_t &alive, size_t width) override;
+
+    void countRow(size_t row, count_t *out) const override;
+};
+
+
+/* Counts neighbors in a von Neumann (diamond) neighborhood in
+ * constant time per cell. Moving the center one column to the
+ * right removes the left edge of the diamond and adds the right
+ * one; both edges are diagonal segments, summed with prefix sums
+ * kept along the two diagonal directions. */
+class DiamondCounter : public NeighborCounter {
+
+    const int radius;
+    const RowKernels &kernels;
+    ThreadPool *pool;
+    const mask_t *alive = nullptr;
+    size_t width = 0;
+
+    /* Prefix sums of state 1 cells along down-right diagonals
+     * (rising indices) and down-left diagonals (anti-diagonals).
+     * Element [i+1][j+1] holds the sum ending at cell (i, j);
+     * the first row and the first and last columns are zero. */
+    Grid<count_t> diagonalSums;
+    Grid<count_t> antiDiagonalSums;
+
+public:
+
+    explicit DiamondCounter(const BoardArgs &boardArgs, ThreadPool *threadPool = nullptr);
+
+    void prepare(const mask_t &alive, size_t width) override;
+
+    void countRow(size_t row, count_t *out) const override;
+
+private:
+
+    /* Returns the count of state 1 cells on the segment starting
+     * at (row, col) and going 'length' cells down and right.
+     * Parts of the segment outside of the board are skipped. */
+    count_t sumDiagonal(long row, long col, long length) const;
+
+    /* Same as sumDiagonal(), for a segment going down and left. */
+    count_t sumAntiDiagonal(long row, long col, long length) const;
+};
+
+
+/* Counts neighbors in a neighborhood of any shape, compiled into
+ * spans of its rows. Prefix sums of every row, and sums of every
+ * other cell for spans with a step of 2, are built once per
+ * generation; then every span adds the difference of two sums to
+ * a whole row of counts at once. A count takes time proportional
+ * to the count of spans, 2r+1 for convex shapes, not to the count
+ * of cells in the neighborhood. */
+class SpanCounter : public NeighborCounter {
+
+    const int radius;
+    const NeighborhoodShape shape;
+    const bool isStepped;               // some spans need steppedSums
+    const RowKernels &kernels;
+    ThreadPool *pool;
+    const mask_t *alive = nullptr;
+    size_t width = 0;
+
+    /* Rows are padded with r empty cells on both sides; element
+     * [i][k] of rowSums holds the count of state 1 cells before
+     * the padded column k of row i, and of steppedSums the count
+     * of state 1 cells before it in columns k-2, k-4, ... */
+    Grid<count_t> rowSums;
+    Grid<count_t> steppedSums;
+
+public:
+
+    explicit SpanCounter(const BoardArgs &boardArgs, ThreadPool *threadPool = nullptr);
+
+    void prepare(const mask_t &alive, size_t width) override;
+
+    void countRow(size_t row, count_t *out) const override;
+};
+
+
+/* Writes rows [first, last) of the next generation of cells and
+ * of their alive mask, with neighborhood counts from a counter
+ * prepared for the current alive mask. The counter may be prepared
+ * for a copy of the mask padded with 'haloRows' rows and 'haloCols'
+ * columns on both sides. 'neighbors' has to hold counts of a whole
+ * row of the counter. Changes of every written row are added to
+ * 'delta', unless it is null. */
+void advanceRows(const NeighborCounter &counter, const RowKernels &kernels, const TransitionView &rules,
+                 const cells_t &cells, cells_t &nextCells, mask_t &nextAlive,
+                 size_t first, size_t last, count_t *neighbors,
+                 size_t haloRows = 0, size_t haloCols = 0, StatsDelta *delta = nullptr);
+
+
+/* Creates the fastest engine able to count neighbors
+ * for the neighborhood described in boardArgs, using the
+ * threads of 'threadPool' if it is not null. */
+std::unique_ptr<NeighborCounter> makeNeighborCounter(const BoardArgs &boardArgs, ThreadPool *threadPool = nullptr);
@@ -0,0 +1,155 @@
+#include "frame_ring.hpp"
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Marks shared memory created by a FrameRing. */
+const std::uint64_t FRAME_RING_MAGIC = 0x4c744c4672616d65ULL;   // "LtLFrame"
+
+/* Returns the count of bytes of a ring of the given size: a header
+ * and the slots, each on its own cache line, then the frames. */
+inline size_t getFrameRingBytes(size_t height, size_t width, size_t slotCount) {
+    return CACHE_LINE_SIZE + slotCount * CACHE_LINE_SIZE + slotCount * height * width * sizeof(cell_t);
+}
+
+
+FrameRing::FrameRing(const std::string &ringName, size_t height, size_t width, size_t slotCount)
+        : name(ringName), isOwner(true) {
+    static_assert(sizeof(Header) <= CACHE_LINE_SIZE, "Frame ring header has to fit in a cache line");
+    if (height == 0 || width == 0)
+        throw std::invalid_argument("Frame dimensions have to be positive");
+    if (slotCount < 2)
+        throw std::invalid_argument("Frame ring needs at least 2 slots");
+
+    // memory left by a process which did not exit cleanly is replaced
+    shm_unlink(name.c_str());
+    const int descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (descriptor < 0)
+        throw std::system_error(errno, std::generic_category(), "Cannot create shared memory " + name);
+
+    bytes = getFrameRingBytes(height, width, slotCount);
+    if (ftruncate(descriptor, (off_t) bytes) != 0) {
+        const int error = errno;
+        close(descriptor);
+        shm_unlink(name.c_str());
+        throw std::system_error(error, std::generic_category(), "Cannot resize shared memory " + name);
+    }
+    map(descriptor);
+
+    header = new (memory) Header{FRAME_RING_MAGIC, height, width, slotCount, {0}};
+    slots = reinterpret_cast<Slot *>(static_cast<char *>(memory) + CACHE_LINE_SIZE);
+    for (size_t slot = 0; slot < slotCount; ++slot)
+        new (&slots[slot]) Slot{{0}};
+    frames = reinterpret_cast<cell_t *>(static_cast<char *>(memory) + CACHE_LINE_SIZE * (1 + slotCount));
+}
+
+FrameRing::FrameRing(const std::string &ringName) : name(ringName), isOwner(false) {
+    const int descriptor = shm_open(name.c_str(), O_RDWR, 0);
+    if (descriptor < 0)
+        throw std::system_error(errno, std::generic_category(), "Cannot open shared memory " + name);
+
+    struct stat status{};
+    if (fstat(descriptor, &status) != 0 || (size_t) status.st_size < CACHE_LINE_SIZE) {
+        close(descriptor);
+        throw std::invalid_argument("Shared memory " + name + " does not hold a frame ring");
+    }
+    bytes = (size_t) status.st_size;
+    map(descriptor);
+
+    header = static_cast<Header *>(memory);
+    slots = reinterpret_cast<Slot *>(static_cast<char *>(memory) + CACHE_LINE_SIZE);
+    if (header->magic != FRAME_RING_MAGIC || header->slots < 2
+    || getFrameRingBytes(header->height, header->width, header->slots) != bytes) {
+        munmap(memory, bytes);
+        throw std::invalid_argument("Shared memory " + name + " does not hold a frame ring");
+    }
+    frames = reinterpret_cast<cell_t *>(static_cast<char *>(memory) + CACHE_LINE_SIZE * (1 + header->slots));
+}
+
+FrameRing::~FrameRing() {
+    munmap(memory, bytes);
+    if (isOwner)
+        shm_unlink(name.c_str());
+}
+
+std::uint64_t FrameRing::publish(const cells_t &cells) {
+    const size_t height = header->height, width = header->width;
+    if (cells.getHeight() != height || cells.getWidth() != width)
+        throw std::invalid_argument("Cell array dimensions do not match the frame size");
+
+    // readers find the slot odd, or with a changed number, if
+    // they look at it while it is written
+    const std::uint64_t number = header->latest.load(std::memory_order_relaxed) + 1;
+    const size_t slot = (size_t) (number % header->slots);
+    slots[slot].sequence.store(2 * number - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    cell_t *frame = getFrame(slot);
+    for (size_t row = 0; row < height; ++row)
+        std::copy(cells[row], cells[row] + width, frame + row * width);
+
+    slots[slot].sequence.store(2 * number, std::memory_order_release);
+    header->latest.store(number, std::memory_order_release);
+    return number;
+}
+
+std::uint64_t FrameRing::readLatest(cells_t &target) const {
+    const size_t height = header->height, width = header->width;
+    if (target.getHeight() != height || target.getWidth() != width)
+        target = cells_t(height, width);
+
+    while (true) {
+        const std::uint64_t number = header->latest.load(std::memory_order_acquire);
+        if (number == 0)
+            return 0;
+
+        // the slot is already reused for a newer frame,
+        // so the latest number has to be read again
+        const size_t slot = (size_t) (number % header->slots);
+        const std::uint64_t sequence = slots[slot].sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * number)
+            continue;
+
+        const cell_t *frame = getFrame(slot);
+        for (size_t row = 0; row < height; ++row)
+            std::copy(frame + row * width, frame + (row + 1) * width, target[row]);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slots[slot].sequence.load(std::memory_order_relaxed) == sequence)
+            return number;
+    }
+}
+
+std::uint64_t FrameRing::getLatestSequence() const {
+    return header->latest.load(std::memory_order_acquire);
+}
+
+size_t FrameRing::getHeight() const {
+    return (size_t) header->height;
+}
+
+size_t FrameRing::getWidth() const {
+    return (size_t) header->width;
+}
+
+void FrameRing::map(int descriptor) {
+    memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    const int error = errno;
+    close(descriptor);
+    if (memory == MAP_FAILED) {
+        memory = nullptr;
+        if (isOwner)
+            shm_unlink(name.c_str());
+        throw std::system_error(error, std::generic_category(), "Cannot map shared memory " + name);
+    }
+}
+
+cell_t *FrameRing::getFrame(size_t slot) const {
+    return frames + slot * header->height * header->width;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "board.hpp"
+
+/* Count of frames a ring holds by default. With three slots the
+ * writer can fill one while a reader copies another. */
+const size_t FRAME_SLOTS = 3;
+
+/* Ring of board frames in POSIX shared memory, written by a single
+ * process and read by others, without locks and without growing.
+ * Every slot has a sequence number, odd while the slot is being
+ * written (a seqlock): readers copy a slot and retry if its number
+ * was odd or changed meanwhile. Frames are numbered from 1, and the
+ * header tells the number of the latest one, so readers always get
+ * the newest frame and skip the ones they were too slow to see. */
+class FrameRing {
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                  "Frame sequence numbers have to be lock-free to be shared between processes");
+
+    struct Header {
+        std::uint64_t magic;
+        std::uint64_t height;
+        std::uint64_t width;
+        std::uint64_t slots;
+        std::atomic<std::uint64_t> latest;  // number of the latest frame, 0 before the first
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<std::uint64_t> sequence;    // twice the frame number, plus 1 while written
+    };
+
+    std::string name;
+    bool isOwner;           // the owner removes the memory when destroyed
+    void *memory = nullptr;
+    size_t bytes = 0;
+    Header *header = nullptr;
+    Slot *slots = nullptr;
+    cell_t *frames = nullptr;
+
+public:
+
+    /* Creates shared memory named 'ringName' (a slash and a few
+     * characters, as for shm_open) for frames of the given size,
+     * replacing memory left under that name before. */
+    FrameRing(const std::string &ringName, size_t height, size_t width, size_t slotCount = FRAME_SLOTS);
+
+    /* Opens a ring created by another FrameRing under 'ringName'. */
+    explicit FrameRing(const std::string &ringName);
+
+    FrameRing(const FrameRing &) = delete;
+    FrameRing &operator=(const FrameRing &) = delete;
+
+    /* Unmaps the memory; the creating object removes its name too. */
+    ~FrameRing();
+
+    /* Writes the cells as the next frame; only one process at
+     * a time may publish. Returns the number of the frame. */
+    std::uint64_t publish(const cells_t &cells);
+
+    /* Copies the latest frame into 'target', which is resized to
+     * the frame size if needed, and returns its number; returns 0
+     * if nothing has been published yet. */
+    std::uint64_t readLatest(cells_t &target) const;
+
+    /* Returns the number of the latest frame, 0 if there is none. */
+    std::uint64_t getLatestSequence() const;
+
+    size_t getHeight() const;
+
+    size_t getWidth() const;
+
+private:
+
+    /* Maps 'bytes' bytes of the shared memory open as 'descriptor',
+     * and closes the descriptor. */
+    void map(int descriptor);
+
+    /* Returns the first cell of a frame slot. */
+    cell_t *getFrame(size_t slot) const;
+};
@@ -1,6 +1,7 @@
-from typing import Any, Dict, List
+from typing import Any, Dict, Sequence
 import pygame
 import myrandoms
+import board
 
 
 class Game:
@@ -11,7 +12,9 @@ class Game:
     _tile_size = 10
     _dead_color = (115, 140, 165)
     _alive_color = (165, 230, 130)
+    _gap_color = (0, 0, 0)
     _states_number = None  # nunmber of states that can cell be
+    _renderer = None
 
     def __init__(self, screen: pygame.Surface, params: Dict) -> Any:
         """Creates object of class Game that is responsible
@@ -38,21 +41,19 @@ class Game:
         else:
             states = params["Cc"]
         self._states_number = states
+        self._renderer = board.Renderer(states, self._tile_size, 1,
+                                        self._dead_color, self._alive_color,
+                                        self._gap_color)
 
-    def update(self, new_values: List[List[int]]) -> None:
+    def update(self, new_values: Sequence[Sequence[int]]) -> None:
         """Updates rects on pygame.Screen to new states
 
         Args:
-            new_values (List[List[int]]): new states of cells
+            new_values (Sequence[Sequence[int]]): new states of cells,
+                a list of rows or a 2-dimensional array
         """
-        for y in range(self._height):
-            for x in range(self._width):
-                color = self.pick_color(new_values[x][y])
-                pygame.draw.rect(self._screen, color,
-                                 pygame.Rect(x*(self._tile_size)+1,
-                                             y*(self._tile_size)+1,
-                                             self._tile_size-2,
-                                             self._tile_size-2))
+        frame = self._renderer.render(new_values)
+        self._screen.blit(pygame.surfarray.make_surface(frame), (0, 0))
 
     def pick_color(self, value: int) -> tuple[int]:
         """Generates new color depends on cell value
@@ -0,0 +1,101 @@
+#pragma once
+#include <new>
+#include <memory>
+#include <utility>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+
+const size_t CACHE_LINE_SIZE = 64;
+
+/* Two-dimensional container stored in one contiguous,
+ * heap-allocated buffer. Rows are laid out one after another
+ * with a fixed stride, so that every row starts on a cache line
+ * boundary. Padding elements at the end of each row are zeroed. */
+template<typename T>
+class Grid {
+    static_assert(std::is_trivially_copyable<T>::value, "Grid elements must be trivially copyable");
+    static_assert(CACHE_LINE_SIZE % sizeof(T) == 0, "Grid element size must divide the cache line size");
+
+    /* Releases memory obtained with an over-aligned operator new */
+    struct AlignedDelete {
+        void operator()(T *ptr) const {
+            ::operator delete[](ptr, std::align_val_t(CACHE_LINE_SIZE));
+        }
+    };
+
+    size_t height = 0;  // count of rows
+    size_t width = 0;   // count of used elements in a row
+    size_t stride = 0;  // distance between the starts of two rows
+    std::unique_ptr<T[], AlignedDelete> buffer;
+
+public:
+
+    /* Creates an empty grid without any storage. */
+    Grid() = default;
+
+    /* Creates a zero-filled grid with the given dimensions. */
+    Grid(size_t height, size_t width)
+            : height(height), width(width), stride(alignedStride(width)) {
+        if (height == 0 || width == 0) return;
+        buffer.reset(static_cast<T *>(::operator new[](bytes(), std::align_val_t(CACHE_LINE_SIZE))));
+        std::memset(static_cast<void *>(buffer.get()), 0, bytes());
+    }
+
+    Grid(const Grid &other) : Grid(other.height, other.width) {
+        if (buffer) std::memcpy(static_cast<void *>(buffer.get()), other.buffer.get(), bytes());
+    }
+
+    Grid(Grid &&other) noexcept
+            : height(other.height), width(other.width), stride(other.stride),
+              buffer(std::move(other.buffer)) {
+        other.height = other.width = other.stride = 0;
+    }
+
+    Grid &operator=(const Grid &other) {
+        if (this == &other) return *this;
+        if (height != other.height || width != other.width)
+            *this = Grid(other.height, other.width);
+        if (buffer) std::memcpy(static_cast<void *>(buffer.get()), other.buffer.get(), bytes());
+        return *this;
+    }
+
+    Grid &operator=(Grid &&other) noexcept {
+        std::swap(height, other.height);
+        std::swap(width, other.width);
+        std::swap(stride, other.stride);
+        std::swap(buffer, other.buffer);
+        return *this;
+    }
+
+    /* Returns a pointer to the first element of a row. */
+    T *operator[](size_t row) { return buffer.get() + row * stride; }
+    const T *operator[](size_t row) const { return buffer.get() + row * stride; }
+
+    /* Returns a pointer to the beginning of the whole buffer. */
+    T *data() { return buffer.get(); }
+    const T *data() const { return buffer.get(); }
+
+    size_t getHeight() const { return height; }
+    size_t getWidth() const { return width; }
+    size_t getStride() const { return stride; }
+
+    /* Sets every element of the grid (padding included) to zero. */
+    void clear() {
+        if (buffer) std::memset(static_cast<void *>(buffer.get()), 0, bytes());
+    }
+
+private:
+
+    /* Returns the row length in elements, rounded up
+     * to a whole number of cache lines. */
+    static size_t alignedStride(size_t width) {
+        const size_t perLine = CACHE_LINE_SIZE / sizeof(T);
+        return (width + perLine - 1) / perLine * perLine;
+    }
+
+    /* Returns the size of the buffer in bytes. */
+    size_t bytes() const {
+        return height * stride * sizeof(T);
+    }
+};
@@ -242,7 +242,9 @@ class GUI:
                                       value_format=lambda x: str(round(x)))
         self._manual.add.selector('Middle included: ', [('Yes', 1), ('No', 0)])
         self._manual.add.selector('Neighborhood: ',
-                                  [('Moore', 'm'), ('Neumann', 'n')])
+                                  [('Moore', 'm'), ('Neumann', 'n'),
+                                   ('Circular', 'c'), ('Checkerboard', 'b'),
+                                   ('Cross', '+'), ('Hash', '#')])
         self._manual.add.text_input('Birth condition: ', default='2-3')
         self._manual.add.text_input('Survival condition: ', default='2')
         self._manual.add.button('Accept', self.start_with_manual_rules)
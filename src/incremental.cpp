@@ -0,0 +1,143 @@
+#include "incremental.hpp"
+#include "bitslice.hpp"
+#include <algorithm>
+
+IncrementalStepper::IncrementalStepper(const BoardArgs &boardArgs, ThreadPool *threadPool)
+        : isMaskOnly(BitSliceStepper::isSupported(boardArgs)),
+          shape(boardArgs),
+          counter(makeNeighborCounter(boardArgs, threadPool)), pool(threadPool) {
+    for (const NeighborhoodSpan &span : shape.getSpans())
+        footprintSize += (size_t) ((span.lastCol - span.firstCol) / span.step + 1);
+}
+
+void IncrementalStepper::reset(const mask_t &alive, size_t width) {
+    const size_t height = alive.getHeight();
+    if (counts.getHeight() != height || counts.getWidth() != width)
+        counts = Grid<count_t>(height, width);
+
+    counter->prepare(alive, width);
+    forEachBand(pool, height, [&](size_t, size_t first, size_t last) {
+        for (size_t row = first; row < last; ++row)
+            counter->countRow(row, counts[row]);
+    });
+
+    firstDirty.assign(height, 0);
+    lastDirty.assign(height, 0);
+    dirtyRows.clear();
+    dirtyCount = 0;
+    changes.clear();
+    flipCount = 0;
+    isCounted = true;
+}
+
+void IncrementalStepper::addChange(size_t row, size_t col, bool isFlip) {
+    markDirty(row, col, col + 1);
+    if (isFlip)
+        forEachInFootprint(row, col, [this](size_t target, size_t firstCol, size_t lastCol, size_t, count_t) {
+            markDirty(target, firstCol, lastCol);
+        });
+}
+
+void IncrementalStepper::invalidate() {
+    isCounted = false;
+}
+
+bool IncrementalStepper::isReady() const {
+    return isCounted;
+}
+
+void IncrementalStepper::step(const RuleTable &rules, const cells_t &cells, const mask_t &alive,
+                              cells_t &nextCells, mask_t &nextAlive) {
+    // the whole next generation is found before any count changes
+    changes.clear();
+    for (const size_t row : dirtyRows) {
+        const count_t *rowCounts = counts[row];
+        for (size_t col = firstDirty[row]; col < lastDirty[row]; ++col) {
+            const cell_t state = isMaskOnly ? (cell_t) isMaskBitSet(alive[row], col) : cells[row][col];
+            const cell_t nextState = rules.next(state, rowCounts[col]);
+            if (nextState != state)
+                changes.push_back({(std::uint32_t) row, (std::uint32_t) col, nextState});
+        }
+        firstDirty[row] = lastDirty[row] = 0;
+    }
+    dirtyRows.clear();
+    dirtyCount = 0;
+
+    flipCount = 0;
+    for (const CellChange &change : changes) {
+        markDirty(change.row, change.col, change.col + 1);
+        const bool wasAlive = isMaskBitSet(alive[change.row], change.col);
+        if (wasAlive == (change.state == 1)) continue;
+        ++flipCount;
+        addFootprint(change.row, change.col, wasAlive ? (count_t) -1 : 1);
+    }
+    writeChanges(nextCells, nextAlive);
+}
+
+void IncrementalStepper::writeChanges(cells_t &targetCells, mask_t &targetAlive) const {
+    for (const CellChange &change : changes) {
+        if (!isMaskOnly)
+            targetCells[change.row][change.col] = (cell_t) change.state;
+        mask_word_t &word = targetAlive[change.row][change.col / MASK_WORD_BITS];
+        const mask_word_t bit = (mask_word_t) 1 << (change.col % MASK_WORD_BITS);
+        word = change.state == 1 ? word | bit : word & ~bit;
+    }
+}
+
+const std::vector<CellChange> & IncrementalStepper::getChanges() const {
+    return changes;
+}
+
+size_t IncrementalStepper::getFlipCount() const {
+    return flipCount;
+}
+
+size_t IncrementalStepper::getCandidateCount() const {
+    return dirtyCount;
+}
+
+size_t IncrementalStepper::getFootprintSize() const {
+    return footprintSize;
+}
+
+void IncrementalStepper::addFootprint(size_t row, size_t col, count_t delta) {
+    forEachInFootprint(row, col, [this, delta](size_t target, size_t firstCol, size_t lastCol,
+                                               size_t step, count_t weight) {
+        count_t *rowCounts = counts[target];
+        const count_t weightedDelta = weight * delta;
+        for (size_t targetCol = firstCol; targetCol < lastCol; targetCol += step)
+            rowCounts[targetCol] += weightedDelta;
+        markDirty(target, firstCol, lastCol);
+    });
+}
+
+template<typename Visit>
+void IncrementalStepper::forEachInFootprint(size_t row, size_t col, Visit visit) {
+    const long height = (long) counts.getHeight(), width = (long) counts.getWidth();
+    for (const NeighborhoodSpan &span : shape.getSpans()) {
+        const long target = (long) row - span.rowOffset;
+        if (target < 0 || target >= height) continue;
+
+        // first column of the mirrored span within the board, on its step
+        long firstCol = (long) col - span.lastCol;
+        if (firstCol < 0)
+            firstCol += (-firstCol + span.step - 1) / span.step * span.step;
+        const long lastCol = std::min((long) col - span.firstCol + 1, width);
+        if (firstCol < lastCol)
+            visit((size_t) target, (size_t) firstCol, (size_t) lastCol, (size_t) span.step, span.weight);
+    }
+}
+
+void IncrementalStepper::markDirty(size_t row, size_t firstCol, size_t lastCol) {
+    size_t &first = firstDirty[row], &last = lastDirty[row];
+    if (first == last) {
+        dirtyRows.push_back(row);
+        first = firstCol;
+        last = lastCol;
+    } else {
+        dirtyCount -= last - first;
+        first = std::min(first, firstCol);
+        last = std::max(last, lastCol);
+    }
+    dirtyCount += last - first;
+}
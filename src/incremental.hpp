@@ -0,0 +1,112 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "board.hpp"
+#include "neighborhood.hpp"
+#include "counting.hpp"
+#include "thread_pool.hpp"
+
+/* Advances a board by keeping the neighborhood count of every cell
+ * between generations. Counts change only around cells which became
+ * state 1, or stopped being in state 1, so only their footprints
+ * are added or subtracted. A cell whose state and count are the same
+ * as in the last generation gets the same next state from the rules,
+ * that is, it keeps its state; so only cells changed by the last
+ * generation, and cells in the footprints of flips, are visited.
+ * Cells to visit are kept as a span of columns per row, so counts
+ * are updated and cells are visited in runs along rows. Work per
+ * generation grows with the count of flips times the size of the
+ * neighborhood, not with the size of the board. Edges of the board
+ * are never wrapped. */
+class IncrementalStepper {
+
+    const bool isMaskOnly;          // two-state rules, cells are left out
+    const NeighborhoodShape shape;
+    size_t footprintSize = 0;       // cells of the spans of the neighborhood
+    std::unique_ptr<NeighborCounter> counter;   // engine for full counts at reset
+    ThreadPool *pool;
+
+    Grid<count_t> counts;           // state 1 cells in each neighborhood, center included
+
+    /* Columns [firstDirty, lastDirty) of a row are visited by the
+     * next step; rows with any of them are listed in dirtyRows. */
+    std::vector<size_t> firstDirty;
+    std::vector<size_t> lastDirty;
+    std::vector<size_t> dirtyRows;
+    size_t dirtyCount = 0;          // count of cells in the spans
+
+    std::vector<CellChange> changes;    // cells changed by the last step
+    size_t flipCount = 0;           // changes into or out of state 1
+    bool isCounted = false;         // counts match the current generation
+
+public:
+
+    /* Full counts at reset are done by the threads of 'threadPool',
+     * or by the calling thread only, if it is null. */
+    explicit IncrementalStepper(const BoardArgs &boardArgs, ThreadPool *threadPool = nullptr);
+
+    /* Counts neighborhoods of the whole alive mask of a board
+     * 'width' cells wide. No cell is visited by the next step,
+     * until it is added with addChange(). */
+    void reset(const mask_t &alive, size_t width);
+
+    /* Makes a cell changed by the last generation, which was
+     * not advanced by this engine, visited by the next step,
+     * together with its neighborhood if it moved into or out of
+     * state 1. Counts are not changed. */
+    void addChange(size_t row, size_t col, bool isFlip);
+
+    /* Marks the counts as outdated, after the board has been
+     * advanced by another engine. */
+    void invalidate();
+
+    /* Returns true if the counts match the generation given
+     * to the last call of step() or reset(). */
+    bool isReady() const;
+
+    /* Writes the changes of the next generation into 'nextCells'
+     * and 'nextAlive', which have to hold the current generation,
+     * and updates the counts. The cells are left out (and may be
+     * empty) when rules are advanced on the alive mask only. */
+    void step(const RuleTable &rules, const cells_t &cells, const mask_t &alive,
+              cells_t &nextCells, mask_t &nextAlive);
+
+    /* Writes the changes of the last step into the given buffers,
+     * to bring another copy of the last generation up to date. */
+    void writeChanges(cells_t &targetCells, mask_t &targetAlive) const;
+
+    /* Returns the cells changed by the last step, in no order. */
+    const std::vector<CellChange> &getChanges() const;
+
+    /* Returns the count of cells which the last step moved into
+     * or out of state 1. */
+    size_t getFlipCount() const;
+
+    /* Returns the count of cells the next step visits. */
+    size_t getCandidateCount() const;
+
+    /* Returns the count of counts updated for a single flip. */
+    size_t getFootprintSize() const;
+
+private:
+
+    /* Adds 'delta' (or subtracts, wrapping around) times the weights
+     * of the neighborhood to the counts of cells having a cell in
+     * their neighborhood, and makes those cells candidates. */
+    void addFootprint(size_t row, size_t col, count_t delta);
+
+    /* Calls visit(row, firstCol, lastCol, step, weight) for every
+     * span of cells having a cell in their neighborhood, that is,
+     * of the neighborhood mirrored around the cell, clipped to
+     * the board edges. Columns [firstCol, lastCol) are visited
+     * every 'step' columns. */
+    template<typename Visit>
+    void forEachInFootprint(size_t row, size_t col, Visit visit);
+
+    /* Makes cells in columns [firstCol, lastCol) of a row,
+     * and all between them and the span of the row, visited
+     * by the next step. */
+    void markDirty(size_t row, size_t firstCol, size_t lastCol);
+};
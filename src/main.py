@@ -1,56 +1,95 @@
+import os
+import sys
 import multiprocessing as mp
 from src.gui import GUI
 import pygame
 from time import sleep
-from board import Board, BoardArgs
+from board import Board, BoardArgs, FrameRing, NeighborhoodType, Evolution
 
+NEIGHBORHOOD_TYPES = {
+    "m": NeighborhoodType.MOORE,
+    "n": NeighborhoodType.VON_NEUMANN,
+    "c": NeighborhoodType.CIRCULAR,
+    "b": NeighborhoodType.CHECKERBOARD,
+    "+": NeighborhoodType.CROSS,
+    "#": NeighborhoodType.HASH,
+}
 
-def calc(params, q, lock):
+
+def create_board(params):
     boardArgs = BoardArgs()
     boardArgs.states = params["Cc"]
     boardArgs.neighborhoodRadius = params["Rr"]
     boardArgs.birthConds = set(params["Bb"])
     boardArgs.surviveConds = set(params["Ss"])
-    boardArgs.isMooreType = params["Nn"] == "m"
+    boardArgs.neighborhoodType = NEIGHBORHOOD_TYPES[params["Nn"]]
     boardArgs.isIncludeCenter = params["Mm"]
     try:
-        board = Board(boardArgs, params["board"])
+        return Board(boardArgs, params["board"])
     except Exception:
-        board = Board(boardArgs)
+        return Board(boardArgs)
+
+
+def calc(params, ring_name):
+    board = create_board(params)
+    # LTL_METRICS=1 logs metrics of every generation to stderr
+    is_metrics_logged = os.environ.get("LTL_METRICS") == "1"
+    board.recordMetrics(is_metrics_logged)
+    board.trackCycles(True)
+    ring = FrameRing(ring_name)
     while True:
-        cells = board.getCells()
-        lock.acquire()
-        q.put(cells)
-        lock.release()
+        ring.publish(board)
         sleep(0.1)
+        is_running = board.getCycleReport().evolution == Evolution.RUNNING
         board.update()
+        if is_metrics_logged:
+            log_metrics(board.getMetrics())
+        report = board.getCycleReport()
+        if is_running and report.evolution != Evolution.RUNNING:
+            print(f"{report.evolution.name.lower()} with period {report.period} "
+                  f"at generation {report.generation}", file=sys.stderr)
+
+
+def log_metrics(metrics):
+    print(f"births={metrics.births} deaths={metrics.deaths} "
+          f"agings={metrics.agings} population={metrics.population} "
+          f"skipped={metrics.cellsSkipped} "
+          f"count={metrics.countSeconds * 1e3:.3f}ms "
+          f"transition={metrics.transitionSeconds * 1e3:.3f}ms "
+          f"copy={metrics.copySeconds * 1e3:.3f}ms "
+          f"total={metrics.totalSeconds * 1e3:.3f}ms",
+          file=sys.stderr)
 
 
-def update_loop(gui, lock, q, p):
+def update_loop(gui, ring, p):
     sleep(1)
     while not gui.if_close():
         for event in pygame.event.get():
             if event.type == pygame.QUIT:
                 gui.set_gui_close()
                 p.kill()
-        lock.acquire()
-        new_values = q.get()
-        lock.release()
-        gui.game.update(new_values)
-        pygame.display.flip()
+        frame = ring.read()
+        if frame is not None:
+            gui.game.update(frame[1])
+            pygame.display.flip()
         sleep(1)
 
 
 def main():
-    lock = mp.Lock()
     pygame.init()
-    q = mp.Queue()
     gui = GUI()
     gui.choosing_menu()
     sleep(0.1)
-    p = mp.Process(target=calc, args=(gui.get_params(), q, lock,))
+    params = gui.get_params()
+    # frames take the size of the board calc() creates,
+    # which follows the cells drawn in the menu
+    board = create_board(params)
+    ring_name = f"/ltl-frames-{os.getpid()}"
+    ring = FrameRing(ring_name, board.getHeight(), board.getWidth())
+    del board
+    p = mp.Process(target=calc, args=(params, ring_name,))
     p.start()
-    update_loop(gui, lock, q, p)
+    update_loop(gui, ring, p)
 
 
 if __name__ == '__main__':
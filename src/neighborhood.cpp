@@ -0,0 +1,117 @@
+#include "neighborhood.hpp"
+#include <stdexcept>
+#include <cstdlib>
+
+/* Returns the weight of a cell at the given offsets from the
+ * center in a neighborhood of the type given by boardArgs. */
+count_t getShapeWeight(const BoardArgs &boardArgs, int rowOffset, int colOffset) {
+    const int radius = boardArgs.neighborhoodRadius;
+    const int rowDistance = std::abs(rowOffset), colDistance = std::abs(colOffset);
+
+    switch (getNeighborhoodType(boardArgs)) {
+        case NeighborhoodType::MOORE:
+            return 1;
+        case NeighborhoodType::VON_NEUMANN:
+            return rowDistance + colDistance <= radius;
+        case NeighborhoodType::CIRCULAR:
+            // within the distance r+1/2 from the center
+            return rowOffset * rowOffset + colOffset * colOffset <= radius * (radius + 1);
+        case NeighborhoodType::CHECKERBOARD:
+            return (rowDistance + colDistance) % 2 == 1;
+        case NeighborhoodType::CROSS:
+            return rowOffset == 0 || colOffset == 0;
+        case NeighborhoodType::HASH:
+            return rowDistance == 1 || colDistance == 1;
+        case NeighborhoodType::CUSTOM:
+            return (count_t) boardArgs.neighborhoodWeights[(size_t) ((rowOffset + radius) * (2 * radius + 1)
+                                                                     + colOffset + radius)];
+    }
+    throw std::invalid_argument("Unknown neighborhood type");
+}
+
+
+NeighborhoodShape::NeighborhoodShape(const BoardArgs &boardArgs)
+        : radius(boardArgs.neighborhoodRadius) {
+    checkNeighborhoodArgsCorrect(boardArgs);
+
+    const int side = 2 * radius + 1;
+    weights.assign((size_t) (side * side), 0);
+    for (int rowOffset = -radius; rowOffset <= radius; ++rowOffset) {
+        for (int colOffset = -radius; colOffset <= radius; ++colOffset) {
+            if (rowOffset == 0 && colOffset == 0) continue;
+            const count_t weight = getShapeWeight(boardArgs, rowOffset, colOffset);
+            weights[(size_t) ((rowOffset + radius) * side + colOffset + radius)] = weight;
+            size += weight;
+        }
+    }
+    weights[(size_t) (radius * side + radius)] = 1;
+
+    for (int rowOffset = -radius; rowOffset <= radius; ++rowOffset)
+        addRowSpans(rowOffset);
+}
+
+int NeighborhoodShape::getRadius() const {
+    return radius;
+}
+
+count_t NeighborhoodShape::getWeight(int rowOffset, int colOffset) const {
+    if (std::abs(rowOffset) > radius || std::abs(colOffset) > radius)
+        return 0;
+    return weights[(size_t) ((rowOffset + radius) * (2 * radius + 1) + colOffset + radius)];
+}
+
+const std::vector<NeighborhoodSpan> & NeighborhoodShape::getSpans() const {
+    return spans;
+}
+
+bool NeighborhoodShape::hasSteppedSpans() const {
+    for (const NeighborhoodSpan &span : spans)
+        if (span.step == 2) return true;
+    return false;
+}
+
+count_t NeighborhoodShape::getSize() const {
+    return size;
+}
+
+void NeighborhoodShape::addRowSpans(int rowOffset) {
+    // weights left to cover, zeroed once a span takes them
+    std::vector<count_t> left;
+    for (int colOffset = -radius; colOffset <= radius; ++colOffset)
+        left.push_back(getWeight(rowOffset, colOffset));
+
+    const int side = 2 * radius + 1;
+    for (int first = 0; first < side; ++first) {
+        const count_t weight = left[(size_t) first];
+        if (weight == 0) continue;
+
+        int lastDense = first, lastSparse = first;
+        while (lastDense + 1 < side && left[(size_t) lastDense + 1] == weight)
+            ++lastDense;
+        while (lastSparse + 2 < side && left[(size_t) lastSparse + 2] == weight)
+            lastSparse += 2;
+
+        const int step = (lastSparse - first) / 2 > lastDense - first ? 2 : 1;
+        const int last = step == 2 ? lastSparse : lastDense;
+        for (int col = first; col <= last; col += step)
+            left[(size_t) col] = 0;
+        spans.push_back({rowOffset, first - radius, last - radius, step, weight});
+    }
+}
+
+
+void checkNeighborhoodArgsCorrect(const BoardArgs &boardArgs) {
+    if (boardArgs.neighborhoodRadius < 0)
+        throw std::invalid_argument("Neighborhood radius out of range");
+
+    if (getNeighborhoodType(boardArgs) != NeighborhoodType::CUSTOM)
+        return;
+
+    const size_t side = 2 * (size_t) boardArgs.neighborhoodRadius + 1;
+    if (boardArgs.neighborhoodWeights.size() != side * side)
+        throw std::invalid_argument("Custom neighborhood weights do not match the radius");
+
+    for (int weight : boardArgs.neighborhoodWeights)
+        if (weight < 0 || weight > NEIGHBORHOOD_WEIGHT_MAX)
+            throw std::invalid_argument("Custom neighborhood weight out of range");
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include "board.hpp"
+
+/* Highest weight of a cell of a custom neighborhood. */
+const int NEIGHBORHOOD_WEIGHT_MAX = 255;
+
+/* Cells of a row of a neighborhood, relative to its center: every
+ * 'step'-th column from firstCol to lastCol, each counted 'weight'
+ * times. Spans with a step of 2 cover rows of a checkerboard. */
+struct NeighborhoodSpan {
+    int rowOffset;
+    int firstCol;
+    int lastCol;    // included, reached from firstCol in steps
+    int step;       // 1 or 2
+    count_t weight;
+};
+
+/* Neighborhood of any type, compiled once into spans of its rows,
+ * so that counting engines add a few ranges of prefix sums per row
+ * instead of testing every cell of the neighborhood. The center
+ * always belongs to the spans, with the weight 1, as counts of
+ * the rules include it; its weight from custom neighborhoods is
+ * ignored and isIncludeCenter decides on it instead. */
+class NeighborhoodShape {
+
+    int radius = 0;
+    std::vector<count_t> weights;           // (2r+1)^2 weights, row by row, center included
+    std::vector<NeighborhoodSpan> spans;    // spans of all rows, top to bottom
+    count_t size = 0;                       // sum of weights, center excluded
+
+public:
+
+    /* Compiles the neighborhood described in boardArgs. */
+    explicit NeighborhoodShape(const BoardArgs &boardArgs);
+
+    int getRadius() const;
+
+    /* Returns the weight of the cell at the given offsets from
+     * the center; 0 outside of the neighborhood. */
+    count_t getWeight(int rowOffset, int colOffset) const;
+
+    const std::vector<NeighborhoodSpan> &getSpans() const;
+
+    /* Returns true if any span has a step of 2. */
+    bool hasSteppedSpans() const;
+
+    /* Returns the sum of weights of the cells, center excluded. */
+    count_t getSize() const;
+
+private:
+
+    /* Splits the weights of a row into spans, preferring
+     * spans with a step of 2 when they are longer. */
+    void addRowSpans(int rowOffset);
+};
+
+/* Checks if the neighborhood type and custom weights given by
+ * boardArgs are correct. */
+void checkNeighborhoodArgsCorrect(const BoardArgs &boardArgs);
@@ -0,0 +1,70 @@
+#include "render.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+Renderer::Renderer(int states, size_t tilePixels, size_t gapPixels, Rgb deadColor, Rgb aliveColor, Rgb background)
+        : tileSize(tilePixels), gap(gapPixels), gapColor(background) {
+    if (states > STATES_MAX || states < STATES_MIN)
+        throw std::invalid_argument("States count out of range");
+
+    if (tileSize == 0 || 2 * gap >= tileSize)
+        throw std::invalid_argument("Tiles have to be larger than both of their gaps");
+
+    // states past the last one do not appear on boards, and are black
+    palette[0] = deadColor;
+    palette[1] = aliveColor;
+    const int step = 255 / states;
+    for (int state = 2; state < states; ++state) {
+        const auto gray = (std::uint8_t) (255 - (state - 1) * step);
+        palette[(size_t) state] = {gray, gray, gray};
+    }
+
+    tileRows.resize(palette.size() * tileSize * 3);
+    for (size_t state = 0; state < palette.size(); ++state) {
+        std::uint8_t *row = &tileRows[state * tileSize * 3];
+        for (size_t pixel = 0; pixel < tileSize; ++pixel) {
+            const bool isGap = pixel < gap || pixel >= tileSize - gap;
+            const Rgb color = isGap ? gapColor : palette[state];
+            row[3 * pixel] = color.red;
+            row[3 * pixel + 1] = color.green;
+            row[3 * pixel + 2] = color.blue;
+        }
+    }
+}
+
+Rgb Renderer::getColor(cell_t state) const {
+    return palette[state];
+}
+
+size_t Renderer::getTileSize() const {
+    return tileSize;
+}
+
+void Renderer::render(const cell_t *cells, size_t height, size_t width, size_t stride, std::uint8_t *frame) const {
+    const size_t tileBytes = tileSize * 3;
+    const size_t rowBytes = width * tileBytes;
+
+    for (size_t row = 0; row < height; ++row) {
+        const cell_t *rowCells = cells + row * stride;
+        std::uint8_t *tileTop = frame + row * tileSize * rowBytes;
+
+        // the first inner row of the tiles is drawn cell by cell,
+        // other inner rows are copies of it
+        std::uint8_t *inner = tileTop + gap * rowBytes;
+        for (size_t col = 0; col < width; ++col)
+            std::memcpy(inner + col * tileBytes, &tileRows[rowCells[col] * tileBytes], tileBytes);
+        for (size_t line = gap + 1; line < tileSize - gap; ++line)
+            std::memcpy(tileTop + line * rowBytes, inner, rowBytes);
+
+        for (size_t line = 0; line < tileSize; ++line) {
+            if (line >= gap && line < tileSize - gap) continue;
+            std::uint8_t *pixels = tileTop + line * rowBytes;
+            for (size_t pixel = 0; pixel < width * tileSize; ++pixel) {
+                pixels[3 * pixel] = gapColor.red;
+                pixels[3 * pixel + 1] = gapColor.green;
+                pixels[3 * pixel + 2] = gapColor.blue;
+            }
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "board.hpp"
+
+/* Color of a pixel, as laid out in RGB framebuffers. */
+struct Rgb {
+    std::uint8_t red;
+    std::uint8_t green;
+    std::uint8_t blue;
+};
+
+/* Draws cells as square tiles into an RGB framebuffer. Every cell
+ * takes tileSize x tileSize pixels, with a gap of 'gap' pixels on
+ * each side of the tile left in the gap color. Tile colors come
+ * from a palette built once: dead and fully alive cells have their
+ * own colors, older cells fade along a gray ramp depending on the
+ * count of states. */
+class Renderer {
+
+    std::array<Rgb, 256> palette{};
+    const size_t tileSize;
+    const size_t gap;
+    const Rgb gapColor;
+
+    /* Pixels of a single row of a tile, for every state. */
+    std::vector<std::uint8_t> tileRows;
+
+public:
+
+    /* Creates a renderer of boards with the given count of states,
+     * drawing tiles 'tilePixels' pixels wide, with gaps 'gapPixels'
+     * pixels wide in the color 'background'. */
+    Renderer(int states, size_t tilePixels, size_t gapPixels, Rgb deadColor, Rgb aliveColor, Rgb background);
+
+    /* Returns the color of cells in the given state. */
+    Rgb getColor(cell_t state) const;
+
+    size_t getTileSize() const;
+
+    /* Draws 'height' rows of 'width' cells, 'stride' cells apart,
+     * into 'frame', which has to hold height*tileSize rows of
+     * width*tileSize pixels. Pixel rows follow cell rows. */
+    void render(const cell_t *cells, size_t height, size_t width, size_t stride, std::uint8_t *frame) const;
+};
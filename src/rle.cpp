@@ -0,0 +1,367 @@
+#include "rle.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <sstream>
+#include <cctype>
+#include <cstdio>
+
+/* Rule of patterns without one, Conway's Life. */
+const char *const RLE_DEFAULT_RULE = "R1,C2,M0,S2..3,B3..3,NM";
+
+/* Returns true if the conditions are a single range of counts. */
+inline bool isSingleRange(const conds_t &conds) {
+    return !conds.empty() && *conds.rbegin() - *conds.begin() + 1 == (int) conds.size();
+}
+
+/* Returns the conditions raised by 'shift' as a HROT list of
+ * counts and ranges, e.g. "1-3,6"; negative counts are left out. */
+std::string getCondsList(const conds_t &conds, int shift) {
+    std::string list;
+    for (auto cond = conds.cbegin(); cond != conds.cend();) {
+        const int first = *cond;
+        int last = first;
+        for (++cond; cond != conds.cend() && *cond == last + 1; ++cond)
+            last = *cond;
+        if (last + shift < 0)
+            continue;
+        if (!list.empty())
+            list += ',';
+        list += std::to_string(std::max(first + shift, 0));
+        if (last > first && last + shift > 0)
+            list += '-' + std::to_string(last + shift);
+    }
+    return list;
+}
+
+/* Returns the letter of a neighborhood in Golly rules. */
+char getNeighborhoodLetter(NeighborhoodType type) {
+    switch (type) {
+        case NeighborhoodType::MOORE: return 'M';
+        case NeighborhoodType::VON_NEUMANN: return 'N';
+        case NeighborhoodType::CIRCULAR: return 'C';
+        case NeighborhoodType::CHECKERBOARD: return 'B';
+        case NeighborhoodType::CROSS: return '+';
+        case NeighborhoodType::HASH: return '#';
+        default: throw std::invalid_argument("Custom neighborhoods have no Golly rule");
+    }
+}
+
+/* Returns the number written in 'text', which has to hold
+ * decimal digits only. */
+int parseRuleNumber(const std::string &text, const std::string &rule) {
+    if (text.empty() || text.size() > 9
+    || !std::all_of(text.cbegin(), text.cend(), [](char digit) { return std::isdigit((unsigned char) digit); }))
+        throw std::invalid_argument("Rule " + rule + " is not a Larger than Life rule");
+    return std::stoi(text);
+}
+
+/* Adds the counts of a condition value, a single count or a
+ * range written as "a..b" or "a-b", to the conditions. */
+void parseCondsValue(const std::string &value, conds_t &conds, const std::string &rule) {
+    if (value.empty())
+        return;
+    size_t separator = value.find("..");
+    size_t separatorLength = 2;
+    if (separator == std::string::npos) {
+        separator = value.find('-');
+        separatorLength = 1;
+    }
+    const int first = parseRuleNumber(value.substr(0, separator), rule);
+    const int last = separator == std::string::npos ? first
+                   : parseRuleNumber(value.substr(separator + separatorLength), rule);
+    if (last < first)
+        throw std::invalid_argument("Rule " + rule + " has an empty range of counts");
+    for (int count = first; count <= last; ++count)
+        conds.insert(count);
+}
+
+/* Sets the size and wrapping of boardArgs from a bounded grid of
+ * Golly, a torus "T100,80" or a plane "P100,80"; a single size
+ * gives a square grid. */
+void parseBoundedGrid(const std::string &grid, BoardArgs &boardArgs, const std::string &rule) {
+    if (grid.empty())
+        throw std::invalid_argument("Rule " + rule + " has no bounded grid after the colon");
+    const char type = (char) std::toupper((unsigned char) grid[0]);
+    if (type != 'T' && type != 'P')
+        throw std::invalid_argument("Only torus and plane bounded grids are supported");
+
+    const size_t comma = grid.find(',');
+    const int width = parseRuleNumber(grid.substr(1, comma - 1), rule);
+    const int height = comma == std::string::npos ? width : parseRuleNumber(grid.substr(comma + 1), rule);
+    if (width == 0 || height == 0)
+        throw std::invalid_argument("Bounded grids of unlimited size are not supported");
+    boardArgs.width = (size_t) width;
+    boardArgs.height = (size_t) height;
+    boardArgs.isWrappedHorizontally = boardArgs.isWrappedVertically = type == 'T';
+}
+
+/* Returns the letters of a state in RLE. */
+std::string getRleState(cell_t state, bool isTwoState) {
+    if (isTwoState)
+        return state == 0 ? "b" : "o";
+    if (state == 0)
+        return ".";
+    if (state <= 24)
+        return std::string(1, (char) ('A' + state - 1));
+    return {(char) ('p' + (state - 25) / 24), (char) ('A' + (state - 25) % 24)};
+}
+
+
+std::string getGollyRule(const BoardArgs &boardArgs) {
+    const char letter = getNeighborhoodLetter(getNeighborhoodType(boardArgs));
+    if (boardArgs.isWrappedHorizontally != boardArgs.isWrappedVertically)
+        throw std::invalid_argument("Golly bounded grids wrap both edges or none");
+
+    std::string rule = "R" + std::to_string(boardArgs.neighborhoodRadius) + ",C" + std::to_string(boardArgs.states);
+    const conds_t &survive = boardArgs.surviveConds, &birth = boardArgs.birthConds;
+    if (isSingleRange(survive) && isSingleRange(birth)) {
+        rule += boardArgs.isIncludeCenter ? ",M1" : ",M0";
+        rule += ",S" + std::to_string(*survive.begin()) + ".." + std::to_string(*survive.rbegin());
+        rule += ",B" + std::to_string(*birth.begin()) + ".." + std::to_string(*birth.rbegin());
+    } else {
+        // a surviving cell counts itself if the middle cell is included
+        rule += ",S" + getCondsList(survive, boardArgs.isIncludeCenter ? -1 : 0);
+        rule += ",B" + getCondsList(birth, 0);
+    }
+    rule += ",N";
+    rule += letter;
+    rule += boardArgs.isWrappedHorizontally ? ":T" : ":P";
+    return rule + std::to_string(boardArgs.width) + "," + std::to_string(boardArgs.height);
+}
+
+void parseGollyRule(const std::string &rule, BoardArgs &boardArgs) {
+    const size_t colon = rule.find(':');
+    std::istringstream tokens(rule.substr(0, colon));
+
+    BoardArgs parsed = boardArgs;
+    parsed.states = 2;
+    parsed.isIncludeCenter = false;
+    parsed.neighborhoodType = NeighborhoodType::MOORE;
+    parsed.neighborhoodWeights.clear();
+    parsed.surviveConds.clear();
+    parsed.birthConds.clear();
+    bool hasRadius = false, hasSurvive = false, hasBirth = false;
+
+    // counts and ranges after a comma go on the list of S or B
+    conds_t *list = nullptr;
+    std::string token;
+    while (std::getline(tokens, token, ',')) {
+        token.erase(std::remove_if(token.begin(), token.end(),
+                                   [](char letter) { return std::isspace((unsigned char) letter); }), token.end());
+        if (!token.empty() && std::isdigit((unsigned char) token[0]) && list) {
+            parseCondsValue(token, *list, rule);
+            continue;
+        }
+        if (token.empty())
+            throw std::invalid_argument("Rule " + rule + " is not a Larger than Life rule");
+
+        const std::string value = token.substr(1);
+        list = nullptr;
+        switch (std::toupper((unsigned char) token[0])) {
+            case 'R':
+                parsed.neighborhoodRadius = parseRuleNumber(value, rule);
+                hasRadius = true;
+                break;
+            case 'C':
+                // Golly takes 0 and 1 states as 2 states
+                parsed.states = std::max(parseRuleNumber(value, rule), 2);
+                break;
+            case 'M':
+                if (value != "0" && value != "1")
+                    throw std::invalid_argument("Rule " + rule + " is not a Larger than Life rule");
+                parsed.isIncludeCenter = value == "1";
+                break;
+            case 'S':
+                parseCondsValue(value, parsed.surviveConds, rule);
+                list = &parsed.surviveConds;
+                hasSurvive = true;
+                break;
+            case 'B':
+                parseCondsValue(value, parsed.birthConds, rule);
+                list = &parsed.birthConds;
+                hasBirth = true;
+                break;
+            case 'N': {
+                const std::string letters = "MNCB+#";
+                const size_t type = value.size() == 1
+                                    ? letters.find((char) std::toupper((unsigned char) value[0])) : std::string::npos;
+                if (type == std::string::npos)
+                    throw std::invalid_argument("Neighborhood of rule " + rule + " is not supported");
+                parsed.neighborhoodType = (NeighborhoodType) type;
+                break;
+            }
+            default:
+                throw std::invalid_argument("Rule " + rule + " is not a Larger than Life rule");
+        }
+    }
+    if (!hasRadius || !hasSurvive || !hasBirth)
+        throw std::invalid_argument("Rule " + rule + " is not a Larger than Life rule");
+
+    if (colon != std::string::npos)
+        parseBoundedGrid(rule.substr(colon + 1), parsed, rule);
+    boardArgs = parsed;
+}
+
+std::string writeRle(const BoardArgs &boardArgs, const cells_t &cells) {
+    const std::string rule = getGollyRule(boardArgs);
+    const size_t height = cells.getHeight(), width = cells.getWidth();
+
+    // bounding box [top, bottom) x [left, right) of cells which are not dead
+    size_t top = height, bottom = 0, left = width, right = 0;
+    for (size_t row = 0; row < height; ++row) {
+        const cell_t *rowCells = cells[row];
+        for (size_t col = 0; col < width; ++col) {
+            if (rowCells[col] == 0) continue;
+            top = std::min(top, row);
+            bottom = row + 1;
+            left = std::min(left, col);
+            right = std::max(right, col + 1);
+        }
+    }
+    if (top == height)
+        top = bottom = left = right = 0;
+
+    // Golly puts the middle of a bounded grid at the origin
+    std::string text = "#CXRLE Pos=" + std::to_string((long) left - (long) (width / 2))
+                     + "," + std::to_string((long) top - (long) (height / 2)) + "\n";
+    text += "x = " + std::to_string(right - left) + ", y = " + std::to_string(bottom - top)
+          + ", rule = " + rule + "\n";
+
+    std::string line;
+    const auto append = [&](size_t count, const std::string &token) {
+        const std::string run = count > 1 ? std::to_string(count) + token : token;
+        if (line.size() + run.size() > RLE_LINE_LENGTH) {
+            text += line + "\n";
+            line.clear();
+        }
+        line += run;
+    };
+
+    const bool isTwoState = boardArgs.states == 2;
+    size_t rowEnds = 0;
+    for (size_t row = top; row < bottom; ++row) {
+        const cell_t *rowCells = cells[row];
+        // dead cells at the end of a row are left out
+        size_t end = right;
+        while (end > left && rowCells[end - 1] == 0)
+            --end;
+        if (end == left) {
+            ++rowEnds;
+            continue;
+        }
+        if (rowEnds > 0)
+            append(rowEnds, "$");
+        for (size_t col = left; col < end;) {
+            size_t runEnd = col + 1;
+            while (runEnd < end && rowCells[runEnd] == rowCells[col])
+                ++runEnd;
+            append(runEnd - col, getRleState(rowCells[col], isTwoState));
+            col = runEnd;
+        }
+        rowEnds = 1;
+    }
+    append(1, "!");
+    return text + line + "\n";
+}
+
+RlePattern readRle(const std::string &text) {
+    std::istringstream lines(text);
+    std::string line, rule = RLE_DEFAULT_RULE, body;
+    bool hasHeader = false, hasPosition = false;
+    long positionCol = 0, positionRow = 0;
+    size_t width = 0, height = 0;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (hasHeader) {
+            body += line;
+            if (line.find('!') != std::string::npos)
+                break;
+            continue;
+        }
+        if (line.empty())
+            continue;
+        if (line[0] == '#') {
+            const size_t position = line.find("Pos=");
+            if (line.compare(0, 6, "#CXRLE") == 0 && position != std::string::npos)
+                hasPosition = std::sscanf(line.c_str() + position + 4, "%ld,%ld", &positionCol, &positionRow) == 2;
+            continue;
+        }
+
+        if (std::sscanf(line.c_str(), " x = %zu , y = %zu", &width, &height) != 2)
+            throw std::invalid_argument("RLE header " + line + " is not correct");
+        const size_t ruleKey = line.find("rule");
+        if (ruleKey != std::string::npos) {
+            const size_t equals = line.find('=', ruleKey);
+            if (equals == std::string::npos)
+                throw std::invalid_argument("RLE header " + line + " is not correct");
+            rule = line.substr(equals + 1);
+            rule.erase(std::remove_if(rule.begin(), rule.end(),
+                                      [](char letter) { return std::isspace((unsigned char) letter); }), rule.end());
+        }
+        hasHeader = true;
+    }
+    if (!hasHeader)
+        throw std::invalid_argument("RLE has no header line");
+
+    RlePattern pattern;
+    BoardArgs &args = pattern.args;
+    parseGollyRule(rule, args);
+    long top = 0, left = 0;
+    if (rule.find(':') == std::string::npos) {
+        args.width = width;
+        args.height = height;
+        args.isWrappedHorizontally = args.isWrappedVertically = false;
+    } else if (hasPosition) {
+        left = positionCol + (long) (args.width / 2);
+        top = positionRow + (long) (args.height / 2);
+    } else {
+        left = ((long) args.width - (long) width) / 2;
+        top = ((long) args.height - (long) height) / 2;
+    }
+    if (left < 0 || top < 0 || (size_t) left + width > args.width || (size_t) top + height > args.height)
+        throw std::invalid_argument("Pattern does not fit in its bounded grid");
+
+    pattern.cells = cells_t(args.height, args.width);
+    size_t row = 0, col = 0, count = 0;
+    for (size_t index = 0; index < body.size(); ++index) {
+        const char letter = body[index];
+        if (std::isspace((unsigned char) letter))
+            continue;
+        if (std::isdigit((unsigned char) letter)) {
+            count = count * 10 + (size_t) (letter - '0');
+            if (count > args.width * args.height)
+                throw std::invalid_argument("RLE run is longer than its pattern");
+            continue;
+        }
+        const size_t run = std::max(count, (size_t) 1);
+        count = 0;
+        if (letter == '!')
+            break;
+        if (letter == '$') {
+            row += run;
+            col = 0;
+            continue;
+        }
+
+        int state;
+        if (letter == 'b' || letter == '.')
+            state = 0;
+        else if (letter == 'o')
+            state = 1;
+        else if (letter >= 'A' && letter <= 'X')
+            state = letter - 'A' + 1;
+        else if (letter >= 'p' && letter <= 'y' && index + 1 < body.size()
+              && body[index + 1] >= 'A' && body[index + 1] <= 'X')
+            state = 25 + (letter - 'p') * 24 + (body[++index] - 'A');
+        else
+            throw std::invalid_argument(std::string("RLE has an unknown state ") + letter);
+
+        if (state > 255 || row >= height || col + run > width)
+            throw std::invalid_argument("RLE cells go beyond the size of the pattern");
+        cell_t *target = pattern.cells[(size_t) top + row] + (size_t) left + col;
+        std::fill(target, target + run, (cell_t) state);
+        col += run;
+    }
+    return pattern;
+}
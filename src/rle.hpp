@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include "board.hpp"
+
+/* Longest line of RLE written by writeRle(), as in Golly. */
+const size_t RLE_LINE_LENGTH = 70;
+
+/* Rules and cells of a pattern read from RLE. */
+struct RlePattern {
+    BoardArgs args;
+    cells_t cells;
+};
+
+/* Returns the rules of boardArgs in the Larger than Life syntax
+ * of Golly, e.g. "R5,C2,M1,S34..58,B34..45,NM:T100,80". Rules
+ * with conditions other than a single range are written in the
+ * HROT syntax, "R2,C2,S1-3,6,B3,NM", which has no middle cell, so
+ * survival conditions are lowered by one if it is included. The
+ * board size is written as a torus or plane bounded grid. */
+std::string getGollyRule(const BoardArgs &boardArgs);
+
+/* Sets the rules of boardArgs, and its size and wrapping if a
+ * bounded grid is given, from a rule in the Larger than Life or
+ * HROT syntax of Golly. Other fields of boardArgs are left. */
+void parseGollyRule(const std::string &rule, BoardArgs &boardArgs);
+
+/* Returns the cells in the RLE format of Golly: the bounding box
+ * of cells which are not dead, placed on the bounded grid of the
+ * rule by a #CXRLE line. Two-state rules are written with 'b' and
+ * 'o', others with '.' and the letters of multi-state rules. */
+std::string writeRle(const BoardArgs &boardArgs, const cells_t &cells);
+
+/* Reads a pattern from RLE text. The board has the size of the
+ * bounded grid of the rule, with the pattern placed as Golly does,
+ * or else the size of the pattern. Patterns without a rule follow
+ * Conway's Life. */
+RlePattern readRle(const std::string &text);
@@ -0,0 +1,352 @@
+#include "simd.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LTL_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+/* ---------- Scalar kernels ---------- */
+
+static void combineRowsScalar(const count_t *plus, const count_t *minus, const count_t *otherMinus,
+                              const count_t *otherPlus, count_t *out, size_t length) {
+    for (size_t i = 0; i < length; ++i)
+        out[i] = plus[i] - minus[i] - otherMinus[i] + otherPlus[i];
+}
+
+static void accumulateRowsScalar(const count_t *plus, const count_t *minus, const count_t *otherMinus,
+                                 const count_t *otherPlus, count_t *out, size_t length) {
+    for (size_t i = 0; i < length; ++i)
+        out[i] += plus[i] - minus[i] - otherMinus[i] + otherPlus[i];
+}
+
+/* Handles cells [first, last) of a row one at a time, packing
+ * the mask bits of whole words starting at 'first'. */
+static void transitionCellsScalar(const TransitionView &rules, const cell_t *states, const count_t *counts,
+                                  cell_t *next, mask_word_t *nextMask, size_t first, size_t last) {
+    for (size_t word = first / MASK_WORD_BITS, col = first; col < last; ++word) {
+        const size_t end = std::min(col + MASK_WORD_BITS, last);
+        mask_word_t bits = 0;
+        for (size_t bit = 0; col < end; ++col, ++bit) {
+            const count_t count = counts[col];
+            const std::uint8_t conditions = rules.conditionBits[count < rules.lastCount ? count : rules.lastCount];
+            const cell_t state = rules.transitions[((size_t) states[col] << 2) | conditions];
+            next[col] = state;
+            bits |= (mask_word_t) (state == 1) << bit;
+        }
+        nextMask[word] = bits;
+    }
+}
+
+static void transitionRowScalar(const TransitionView &rules, const cell_t *states, const count_t *counts,
+                                cell_t *next, mask_word_t *nextMask, size_t width) {
+    transitionCellsScalar(rules, states, counts, next, nextMask, 0, width);
+}
+
+static const RowKernels scalarKernels = {
+    InstructionSet::Scalar, combineRowsScalar, accumulateRowsScalar, transitionRowScalar
+};
+
+#ifdef LTL_X86_KERNELS
+
+/* ---------- SSE2 kernels ---------- */
+
+__attribute__((target("sse2")))
+static void combineRowsSSE2(const count_t *plus, const count_t *minus, const count_t *otherMinus,
+                            const count_t *otherPlus, count_t *out, size_t length) {
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        __m128i sum = _mm_sub_epi32(_mm_loadu_si128((const __m128i *) (plus + i)),
+                                    _mm_loadu_si128((const __m128i *) (minus + i)));
+        sum = _mm_sub_epi32(sum, _mm_loadu_si128((const __m128i *) (otherMinus + i)));
+        sum = _mm_add_epi32(sum, _mm_loadu_si128((const __m128i *) (otherPlus + i)));
+        _mm_storeu_si128((__m128i *) (out + i), sum);
+    }
+    combineRowsScalar(plus + i, minus + i, otherMinus + i, otherPlus + i, out + i, length - i);
+}
+
+__attribute__((target("sse2")))
+static void accumulateRowsSSE2(const count_t *plus, const count_t *minus, const count_t *otherMinus,
+                               const count_t *otherPlus, count_t *out, size_t length) {
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        __m128i sum = _mm_sub_epi32(_mm_loadu_si128((const __m128i *) (plus + i)),
+                                    _mm_loadu_si128((const __m128i *) (minus + i)));
+        sum = _mm_sub_epi32(sum, _mm_loadu_si128((const __m128i *) (otherMinus + i)));
+        sum = _mm_add_epi32(sum, _mm_loadu_si128((const __m128i *) (otherPlus + i)));
+        sum = _mm_add_epi32(sum, _mm_loadu_si128((const __m128i *) (out + i)));
+        _mm_storeu_si128((__m128i *) (out + i), sum);
+    }
+    accumulateRowsScalar(plus + i, minus + i, otherMinus + i, otherPlus + i, out + i, length - i);
+}
+
+/* Applies rules to 16 cells, given their condition bits, and
+ * returns the mask bits of the next states. */
+__attribute__((target("sse2")))
+static inline unsigned transitionBytesSSE2(const TransitionView &rules, const cell_t *states,
+                                           const std::uint8_t *conditions, cell_t *next) {
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi8(2);
+    const __m128i stateLimit = _mm_set1_epi8((char) (rules.states & 0xFF));
+
+    const __m128i state = _mm_loadu_si128((const __m128i *) states);
+    const __m128i bits = _mm_loadu_si128((const __m128i *) conditions);
+    const __m128i isDead = _mm_cmpeq_epi8(state, _mm_setzero_si128());
+    const __m128i isAlive = _mm_cmpeq_epi8(state, one);
+
+    // aging cells wrap to 0 after reaching the count of states
+    __m128i aged = _mm_add_epi8(state, one);
+    aged = _mm_andnot_si128(_mm_cmpeq_epi8(aged, stateLimit), aged);
+
+    const __m128i born = _mm_and_si128(bits, one);
+    const __m128i survives = _mm_and_si128(isAlive, _mm_cmpeq_epi8(_mm_and_si128(bits, two), two));
+    const __m128i living = _mm_or_si128(_mm_and_si128(survives, one), _mm_andnot_si128(survives, aged));
+    const __m128i result = _mm_or_si128(_mm_and_si128(isDead, born), _mm_andnot_si128(isDead, living));
+
+    _mm_storeu_si128((__m128i *) next, result);
+    return (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(result, one));
+}
+
+__attribute__((target("sse2")))
+static void transitionRowSSE2(const TransitionView &rules, const cell_t *states, const count_t *counts,
+                              cell_t *next, mask_word_t *nextMask, size_t width) {
+    const size_t fullWords = width / MASK_WORD_BITS;
+    alignas(16) std::uint8_t conditions[16];
+
+    for (size_t word = 0; word < fullWords; ++word) {
+        mask_word_t bits = 0;
+        for (size_t block = 0; block < MASK_WORD_BITS; block += 16) {
+            const size_t col = word * MASK_WORD_BITS + block;
+            for (size_t lane = 0; lane < 16; ++lane) {
+                const count_t count = counts[col + lane];
+                conditions[lane] = rules.conditionBits[count < rules.lastCount ? count : rules.lastCount];
+            }
+            bits |= (mask_word_t) transitionBytesSSE2(rules, states + col, conditions, next + col) << block;
+        }
+        nextMask[word] = bits;
+    }
+    transitionCellsScalar(rules, states, counts, next, nextMask, fullWords * MASK_WORD_BITS, width);
+}
+
+static const RowKernels sse2Kernels = {
+    InstructionSet::SSE2, combineRowsSSE2, accumulateRowsSSE2, transitionRowSSE2
+};
+
+/* ---------- AVX2 kernels ---------- */
+
+__attribute__((target("avx2")))
+static void combineRowsAVX2(const count_t *plus, const count_t *minus, const count_t *otherMinus,
+                            const count_t *otherPlus, count_t *out, size_t length) {
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        __m256i sum = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *) (plus + i)),
+                                       _mm256_loadu_si256((const __m256i *) (minus + i)));
+        sum = _mm256_sub_epi32(sum, _mm256_loadu_si256((const __m256i *) (otherMinus + i)));
+        sum = _mm256_add_epi32(sum, _mm256_loadu_si256((const __m256i *) (otherPlus + i)));
+        _mm256_storeu_si256((__m256i *) (out + i), sum);
+    }
+    combineRowsScalar(plus + i, minus + i, otherMinus + i, otherPlus + i, out + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static void accumulateRowsAVX2(const count_t *plus, const count_t *minus, const count_t *otherMinus,
+                               const count_t *otherPlus, count_t *out, size_t length) {
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        __m256i sum = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *) (plus + i)),
+                                       _mm256_loadu_si256((const __m256i *) (minus + i)));
+        sum = _mm256_sub_epi32(sum, _mm256_loadu_si256((const __m256i *) (otherMinus + i)));
+        sum = _mm256_add_epi32(sum, _mm256_loadu_si256((const __m256i *) (otherPlus + i)));
+        sum = _mm256_add_epi32(sum, _mm256_loadu_si256((const __m256i *) (out + i)));
+        _mm256_storeu_si256((__m256i *) (out + i), sum);
+    }
+    accumulateRowsScalar(plus + i, minus + i, otherMinus + i, otherPlus + i, out + i, length - i);
+}
+
+/* Looks up condition bits of 8 cells with a single gather. */
+__attribute__((target("avx2")))
+static inline __m256i gatherConditionsAVX2(const TransitionView &rules, const count_t *counts) {
+    const __m256i index = _mm256_min_epu32(_mm256_loadu_si256((const __m256i *) counts),
+                                           _mm256_set1_epi32((int) rules.lastCount));
+    const __m256i bits = _mm256_i32gather_epi32((const int *) rules.conditionBits, index, 1);
+    return _mm256_and_si256(bits, _mm256_set1_epi32(0xFF));
+}
+
+__attribute__((target("avx2")))
+static void transitionRowAVX2(const TransitionView &rules, const cell_t *states, const count_t *counts,
+                              cell_t *next, mask_word_t *nextMask, size_t width) {
+    const size_t fullWords = width / MASK_WORD_BITS;
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i two = _mm256_set1_epi8(2);
+    const __m256i stateLimit = _mm256_set1_epi8((char) (rules.states & 0xFF));
+    const __m256i byteOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    for (size_t word = 0; word < fullWords; ++word) {
+        mask_word_t bits = 0;
+        for (size_t block = 0; block < MASK_WORD_BITS; block += 32) {
+            const size_t col = word * MASK_WORD_BITS + block;
+
+            // narrow 32 condition lookups down to bytes in cell order
+            const __m256i low = _mm256_packus_epi32(gatherConditionsAVX2(rules, counts + col),
+                                                    gatherConditionsAVX2(rules, counts + col + 8));
+            const __m256i high = _mm256_packus_epi32(gatherConditionsAVX2(rules, counts + col + 16),
+                                                     gatherConditionsAVX2(rules, counts + col + 24));
+            const __m256i conditions = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(low, high), byteOrder);
+
+            const __m256i state = _mm256_loadu_si256((const __m256i *) (states + col));
+            const __m256i isDead = _mm256_cmpeq_epi8(state, _mm256_setzero_si256());
+            const __m256i isAlive = _mm256_cmpeq_epi8(state, one);
+
+            // aging cells wrap to 0 after reaching the count of states
+            __m256i aged = _mm256_add_epi8(state, one);
+            aged = _mm256_andnot_si256(_mm256_cmpeq_epi8(aged, stateLimit), aged);
+
+            const __m256i born = _mm256_and_si256(conditions, one);
+            const __m256i survives = _mm256_and_si256(isAlive, _mm256_cmpeq_epi8(_mm256_and_si256(conditions, two), two));
+            const __m256i living = _mm256_blendv_epi8(aged, one, survives);
+            const __m256i result = _mm256_blendv_epi8(living, born, isDead);
+
+            _mm256_storeu_si256((__m256i *) (next + col), result);
+            bits |= (mask_word_t) (std::uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(result, one)) << block;
+        }
+        nextMask[word] = bits;
+    }
+    transitionCellsScalar(rules, states, counts, next, nextMask, fullWords * MASK_WORD_BITS, width);
+}
+
+static const RowKernels avx2Kernels = {
+    InstructionSet::AVX2, combineRowsAVX2, accumulateRowsAVX2, transitionRowAVX2
+};
+
+/* ---------- AVX-512 kernels ---------- */
+
+// AVX-512 intrinsics of GCC start from deliberately undefined
+// registers, which -Wmaybe-uninitialized reports
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f")))
+static void combineRowsAVX512(const count_t *plus, const count_t *minus, const count_t *otherMinus,
+                              const count_t *otherPlus, count_t *out, size_t length) {
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m512i sum = _mm512_sub_epi32(_mm512_loadu_si512(plus + i), _mm512_loadu_si512(minus + i));
+        sum = _mm512_sub_epi32(sum, _mm512_loadu_si512(otherMinus + i));
+        sum = _mm512_add_epi32(sum, _mm512_loadu_si512(otherPlus + i));
+        _mm512_storeu_si512(out + i, sum);
+    }
+    combineRowsScalar(plus + i, minus + i, otherMinus + i, otherPlus + i, out + i, length - i);
+}
+
+__attribute__((target("avx512f")))
+static void accumulateRowsAVX512(const count_t *plus, const count_t *minus, const count_t *otherMinus,
+                                 const count_t *otherPlus, count_t *out, size_t length) {
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m512i sum = _mm512_sub_epi32(_mm512_loadu_si512(plus + i), _mm512_loadu_si512(minus + i));
+        sum = _mm512_sub_epi32(sum, _mm512_loadu_si512(otherMinus + i));
+        sum = _mm512_add_epi32(sum, _mm512_loadu_si512(otherPlus + i));
+        sum = _mm512_add_epi32(sum, _mm512_loadu_si512(out + i));
+        _mm512_storeu_si512(out + i, sum);
+    }
+    accumulateRowsScalar(plus + i, minus + i, otherMinus + i, otherPlus + i, out + i, length - i);
+}
+
+__attribute__((target("avx512f")))
+static void transitionRowAVX512(const TransitionView &rules, const cell_t *states, const count_t *counts,
+                                cell_t *next, mask_word_t *nextMask, size_t width) {
+    const size_t fullWords = width / MASK_WORD_BITS;
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i stateLimit = _mm512_set1_epi32(rules.states);
+    const __m512i lastCount = _mm512_set1_epi32((int) rules.lastCount);
+
+    for (size_t word = 0; word < fullWords; ++word) {
+        mask_word_t bits = 0;
+        for (size_t block = 0; block < MASK_WORD_BITS; block += 16) {
+            const size_t col = word * MASK_WORD_BITS + block;
+            const __m512i index = _mm512_min_epu32(_mm512_loadu_si512(counts + col), lastCount);
+            const __m512i conditions = _mm512_and_si512(
+                    _mm512_i32gather_epi32(index, (const int *) rules.conditionBits, 1), _mm512_set1_epi32(0xFF));
+
+            const __m512i state = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *) (states + col)));
+            const __mmask16 isDead = _mm512_cmpeq_epi32_mask(state, zero);
+            const __mmask16 survives = _mm512_cmpeq_epi32_mask(state, one)
+                                       & _mm512_test_epi32_mask(conditions, _mm512_set1_epi32(2));
+
+            // aging cells wrap to 0 after reaching the count of states
+            __m512i result = _mm512_add_epi32(state, one);
+            result = _mm512_mask_mov_epi32(result, _mm512_cmpeq_epi32_mask(result, stateLimit), zero);
+            result = _mm512_mask_mov_epi32(result, survives, one);
+            result = _mm512_mask_mov_epi32(result, isDead, _mm512_and_si512(conditions, one));
+
+            _mm_storeu_si128((__m128i *) (next + col), _mm512_cvtepi32_epi8(result));
+            bits |= (mask_word_t) _mm512_cmpeq_epi32_mask(result, one) << block;
+        }
+        nextMask[word] = bits;
+    }
+    transitionCellsScalar(rules, states, counts, next, nextMask, fullWords * MASK_WORD_BITS, width);
+}
+
+static const RowKernels avx512Kernels = {
+    InstructionSet::AVX512, combineRowsAVX512, accumulateRowsAVX512, transitionRowAVX512
+};
+
+#pragma GCC diagnostic pop
+
+#endif
+
+/* ---------- Dispatch ---------- */
+
+bool isInstructionSetSupported(InstructionSet instructionSet) {
+    switch (instructionSet) {
+        case InstructionSet::Scalar:
+            return true;
+#ifdef LTL_X86_KERNELS
+        case InstructionSet::SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case InstructionSet::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        case InstructionSet::AVX512:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+const RowKernels &getRowKernels(InstructionSet instructionSet) {
+    if (!isInstructionSetSupported(instructionSet))
+        throw std::invalid_argument("Instruction set not supported by the processor");
+
+    switch (instructionSet) {
+#ifdef LTL_X86_KERNELS
+        case InstructionSet::SSE2:
+            return sse2Kernels;
+        case InstructionSet::AVX2:
+            return avx2Kernels;
+        case InstructionSet::AVX512:
+            return avx512Kernels;
+#endif
+        default:
+            return scalarKernels;
+    }
+}
+
+/* Returns kernels of the fastest supported instruction set. */
+static const RowKernels &detectRowKernels() {
+    for (auto instructionSet : {InstructionSet::AVX512, InstructionSet::AVX2, InstructionSet::SSE2}) {
+        if (isInstructionSetSupported(instructionSet))
+            return getRowKernels(instructionSet);
+    }
+    return scalarKernels;
+}
+
+const RowKernels &getRowKernels() {
+    static const RowKernels &kernels = detectRowKernels();
+    return kernels;
+}
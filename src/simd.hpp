@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "board.hpp"
+
+/* Instruction sets with their own row kernels,
+ * ordered from the slowest to the fastest. */
+enum class InstructionSet { Scalar, SSE2, AVX2, AVX512 };
+
+/* Row kernels compiled for a single instruction set. */
+struct RowKernels {
+    InstructionSet instructionSet;
+
+    /* out[i] = plus[i] - minus[i] - otherMinus[i] + otherPlus[i] */
+    void (*combineRows)(const count_t *plus, const count_t *minus, const count_t *otherMinus,
+                        const count_t *otherPlus, count_t *out, size_t length);
+
+    /* out[i] += plus[i] - minus[i] - otherMinus[i] + otherPlus[i] */
+    void (*accumulateRows)(const count_t *plus, const count_t *minus, const count_t *otherMinus,
+                           const count_t *otherPlus, count_t *out, size_t length);
+
+    /* Writes next states of a row of cells, given their neighbor
+     * counts (center included), and the alive mask of the row. */
+    void (*transitionRow)(const TransitionView &rules, const cell_t *states, const count_t *counts,
+                          cell_t *next, mask_word_t *nextMask, size_t width);
+};
+
+/* Returns true if the processor running the program
+ * can execute kernels of the instruction set. */
+bool isInstructionSetSupported(InstructionSet instructionSet);
+
+/* Returns kernels of the given instruction set, which
+ * has to be supported by the processor. */
+const RowKernels &getRowKernels(InstructionSet instructionSet);
+
+/* Returns kernels of the fastest instruction set supported
+ * by the processor, detected once on the first call. */
+const RowKernels &getRowKernels();
@@ -0,0 +1,260 @@
+#include "sparse_board.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+/* Returns value / divisor rounded towards negative infinity. */
+inline coord_t floorDivide(coord_t value, coord_t divisor) {
+    return value >= 0 ? value / divisor : -((-value - 1) / divisor) - 1;
+}
+
+
+SparseBoard::SparseBoard(BoardArgs boardArgs)
+        : args(std::move(boardArgs)),
+          kernels(getRowKernels()),
+          // blocks are at least as wide as both of their halos
+          blockChunks(std::max((size_t) 1, (2 * (size_t) args.neighborhoodRadius + CHUNK_SIZE - 1) / CHUNK_SIZE)) {
+    checkRuleArgsCorrect(args);
+    if (args.birthConds.count(0))
+        throw std::invalid_argument("Births with no neighbors are not supported on a sparse board");
+
+    rules = RuleTable(args);
+    if (args.threads > 1)
+        pool = std::make_unique<ThreadPool>((size_t) args.threads);
+    windows.resize((size_t) args.threads);
+}
+
+void SparseBoard::update() {
+    // Cells more than r cells away from all non-dead cells stay
+    // dead, so only blocks within that reach of a chunk are advanced
+    const coord_t reach = (coord_t) ((args.neighborhoodRadius + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    const coord_t size = (coord_t) blockChunks;
+    std::unordered_set<ChunkKey, ChunkKeyHash> blockSet;
+    for (const auto &entry : chunks) {
+        const ChunkKey &key = entry.first;
+        for (coord_t row = key.row - reach; row <= key.row + reach; ++row)
+            for (coord_t col = key.col - reach; col <= key.col + reach; ++col)
+                blockSet.insert({floorDivide(row, size), floorDivide(col, size)});
+    }
+    const std::vector<ChunkKey> blocks(blockSet.cbegin(), blockSet.cend());
+
+    forEachBand(pool.get(), blocks.size(), [&](size_t band, size_t first, size_t last) {
+        for (size_t block = first; block < last; ++block)
+            advanceBlock(windows[band], blocks[block]);
+    });
+
+    // Every stored chunk lies in an advanced block, so each of
+    // them is either replaced or emptied
+    for (auto &window : windows)
+        mergeChunks(window);
+
+    // spares beyond the stored chunks would outlive a shrinking
+    // board, so all windows together keep at most as many
+    const size_t spareLimit = chunks.size() / windows.size();
+    for (auto &window : windows)
+        if (window.spareCells.size() > spareLimit)
+            window.spareCells.resize(spareLimit);
+}
+
+void SparseBoard::step(size_t generations) {
+    for (size_t generation = 0; generation < generations; ++generation)
+        update();
+}
+
+cell_t SparseBoard::getCell(coord_t row, coord_t col) const {
+    const coord_t size = (coord_t) CHUNK_SIZE;
+    const ChunkKey key{floorDivide(row, size), floorDivide(col, size)};
+    const auto found = chunks.find(key);
+    if (found == chunks.cend())
+        return 0;
+    return found->second.cells[(size_t) (row - key.row * size)][(size_t) (col - key.col * size)];
+}
+
+void SparseBoard::setCell(coord_t row, coord_t col, cell_t state) {
+    if ((int) state >= args.states)
+        throw std::invalid_argument("Cell state out of range");
+
+    const coord_t size = (coord_t) CHUNK_SIZE;
+    const ChunkKey key{floorDivide(row, size), floorDivide(col, size)};
+    auto found = chunks.find(key);
+    if (found == chunks.end()) {
+        if (state == 0) return;
+        found = chunks.emplace(key, Chunk()).first;
+    }
+
+    Chunk &chunk = found->second;
+    cell_t &cell = chunk.cells[(size_t) (row - key.row * size)][(size_t) (col - key.col * size)];
+    chunk.population += (state != 0);
+    chunk.population -= (cell != 0);
+    cell = state;
+    if (chunk.population == 0)
+        chunks.erase(found);
+}
+
+void SparseBoard::setCells(coord_t top, coord_t left, const cells_t &region) {
+    for (size_t row = 0; row < region.getHeight(); ++row)
+        for (size_t col = 0; col < region.getWidth(); ++col)
+            setCell(top + (coord_t) row, left + (coord_t) col, region[row][col]);
+}
+
+cells_t SparseBoard::getRegion(coord_t top, coord_t left, size_t height, size_t width) const {
+    cells_t region(height, width);
+    copyChunks(top, left, region);
+    return region;
+}
+
+BoundingBox SparseBoard::getBoundingBox() const {
+    BoundingBox box;
+    bool isEmpty = true;
+    for (const auto &entry : chunks) {
+        const cells_t &cells = entry.second.cells;
+        const coord_t originRow = entry.first.row * (coord_t) CHUNK_SIZE;
+        const coord_t originCol = entry.first.col * (coord_t) CHUNK_SIZE;
+        for (size_t row = 0; row < CHUNK_SIZE; ++row) {
+            for (size_t col = 0; col < CHUNK_SIZE; ++col) {
+                if (cells[row][col] == 0) continue;
+
+                const coord_t cellRow = originRow + (coord_t) row, cellCol = originCol + (coord_t) col;
+                if (isEmpty) {
+                    box = {cellRow, cellCol, cellRow + 1, cellCol + 1};
+                    isEmpty = false;
+                }
+                box.top = std::min(box.top, cellRow);
+                box.left = std::min(box.left, cellCol);
+                box.bottom = std::max(box.bottom, cellRow + 1);
+                box.right = std::max(box.right, cellCol + 1);
+            }
+        }
+    }
+    return box;
+}
+
+size_t SparseBoard::getPopulation() const {
+    size_t population = 0;
+    for (const auto &entry : chunks)
+        population += entry.second.population;
+    return population;
+}
+
+size_t SparseBoard::getChunkCount() const {
+    return chunks.size();
+}
+
+void SparseBoard::copyChunks(coord_t top, coord_t left, cells_t &target) const {
+    target.clear();
+    if (target.getHeight() == 0 || target.getWidth() == 0) return;
+
+    const coord_t size = (coord_t) CHUNK_SIZE;
+    const coord_t bottom = top + (coord_t) target.getHeight();
+    const coord_t right = left + (coord_t) target.getWidth();
+
+    auto copyChunk = [&](const ChunkKey &key, const Chunk &chunk) {
+        const coord_t originRow = key.row * size, originCol = key.col * size;
+        const coord_t firstRow = std::max(top, originRow), lastRow = std::min(bottom, originRow + size);
+        const coord_t firstCol = std::max(left, originCol), lastCol = std::min(right, originCol + size);
+        for (coord_t row = firstRow; row < lastRow; ++row) {
+            const cell_t *source = chunk.cells[(size_t) (row - originRow)];
+            std::copy(source + (firstCol - originCol), source + (lastCol - originCol),
+                      target[(size_t) (row - top)] + (firstCol - left));
+        }
+    };
+
+    // Large regions are filled from all chunks, small ones
+    // by looking up the chunks they overlap
+    const coord_t firstChunkRow = floorDivide(top, size), lastChunkRow = floorDivide(bottom - 1, size);
+    const coord_t firstChunkCol = floorDivide(left, size), lastChunkCol = floorDivide(right - 1, size);
+    const double overlapped = (double) (lastChunkRow - firstChunkRow + 1) * (double) (lastChunkCol - firstChunkCol + 1);
+    if (overlapped > (double) chunks.size()) {
+        for (const auto &entry : chunks) {
+            const ChunkKey &key = entry.first;
+            if (key.row >= firstChunkRow && key.row <= lastChunkRow && key.col >= firstChunkCol && key.col <= lastChunkCol)
+                copyChunk(key, entry.second);
+        }
+        return;
+    }
+
+    for (coord_t row = firstChunkRow; row <= lastChunkRow; ++row) {
+        for (coord_t col = firstChunkCol; col <= lastChunkCol; ++col) {
+            const auto found = chunks.find({row, col});
+            if (found != chunks.cend())
+                copyChunk(found->first, found->second);
+        }
+    }
+}
+
+void SparseBoard::advanceBlock(Window &window, const ChunkKey &block) const {
+    const size_t r = (size_t) args.neighborhoodRadius;
+    const size_t blockCells = blockChunks * CHUNK_SIZE;
+    const size_t size = blockCells + 2 * r;
+    if (window.cells.getHeight() != size) {
+        window.cells = cells_t(size, size);
+        window.nextCells = cells_t(size, size);
+        window.nextAlive = mask_t(size, getMaskWords(size));
+        window.counter = makeNeighborCounter(args);
+        window.neighbors.resize(size);
+    }
+
+    // Cells past the window are dead, which only matters for
+    // the halo, so inner rows and columns come out exact
+    const coord_t top = block.row * (coord_t) blockCells - (coord_t) r;
+    const coord_t left = block.col * (coord_t) blockCells - (coord_t) r;
+    copyChunks(top, left, window.cells);
+    fillAliveMask(window.cells, window.alive);
+    window.counter->prepare(window.alive, size);
+    advanceRows(*window.counter, kernels, rules.getView(), window.cells, window.nextCells,
+                window.nextAlive, r, r + blockCells, window.neighbors.data());
+
+    for (size_t chunkRow = 0; chunkRow < blockChunks; ++chunkRow) {
+        for (size_t chunkCol = 0; chunkCol < blockChunks; ++chunkCol) {
+            const size_t firstRow = r + chunkRow * CHUNK_SIZE, firstCol = r + chunkCol * CHUNK_SIZE;
+            size_t population = 0;
+            for (size_t row = firstRow; row < firstRow + CHUNK_SIZE; ++row) {
+                const cell_t *source = window.nextCells[row] + firstCol;
+                population += CHUNK_SIZE - (size_t) std::count(source, source + CHUNK_SIZE, 0);
+            }
+
+            const ChunkKey key{block.row * (coord_t) blockChunks + (coord_t) chunkRow,
+                               block.col * (coord_t) blockChunks + (coord_t) chunkCol};
+            if (population == 0) {
+                if (chunks.count(key))
+                    window.emptiedChunks.push_back(key);
+                continue;
+            }
+
+            cells_t cells;
+            if (window.spareCells.empty()) {
+                cells = cells_t(CHUNK_SIZE, CHUNK_SIZE);
+            }
+            else {
+                cells = std::move(window.spareCells.back());
+                window.spareCells.pop_back();
+            }
+            for (size_t row = 0; row < CHUNK_SIZE; ++row) {
+                const cell_t *source = window.nextCells[firstRow + row] + firstCol;
+                std::copy(source, source + CHUNK_SIZE, cells[row]);
+            }
+            window.nextChunks.emplace_back(key, Chunk{std::move(cells), population});
+        }
+    }
+}
+
+void SparseBoard::mergeChunks(Window &window) {
+    for (auto &entry : window.nextChunks) {
+        const auto found = chunks.find(entry.first);
+        if (found == chunks.end()) {
+            chunks.emplace(entry.first, std::move(entry.second));
+            continue;
+        }
+        std::swap(found->second.cells, entry.second.cells);
+        found->second.population = entry.second.population;
+        window.spareCells.push_back(std::move(entry.second.cells));
+    }
+    for (const ChunkKey &key : window.emptiedChunks) {
+        const auto found = chunks.find(key);
+        window.spareCells.push_back(std::move(found->second.cells));
+        chunks.erase(found);
+    }
+    window.nextChunks.clear();
+    window.emptiedChunks.clear();
+}
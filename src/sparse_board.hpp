@@ -0,0 +1,133 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include "board.hpp"
+#include "counting.hpp"
+#include "thread_pool.hpp"
+
+/* Count of rows and columns of a chunk of a sparse board. */
+const size_t CHUNK_SIZE = 64;
+
+/* Coordinate of a cell on an unbounded board; it may be negative. */
+typedef std::int64_t coord_t;
+
+/* Rectangle holding all non-dead cells of a sparse board,
+ * rows [top, bottom) and columns [left, right). */
+struct BoundingBox {
+    coord_t top = 0;
+    coord_t left = 0;
+    coord_t bottom = 0;
+    coord_t right = 0;
+};
+
+
+/* Board without edges, for patterns growing without limit. Cells
+ * are kept in square chunks of CHUNK_SIZE cells, stored in a hash
+ * map under their position. Only chunks holding non-dead cells
+ * are stored: chunks are created when cells reach them and freed
+ * once they empty, so memory follows the population of the board
+ * rather than its extent. Cells of chunks replaced by an update are
+ * kept for the chunks of the next one; all threads together keep
+ * at most as many of them as there are stored chunks. Rules are the
+ * same as on a Board, except for births with no neighbors, which
+ * would fill the whole plane. */
+class SparseBoard {
+
+    /* Position of a chunk, counted in chunks from the origin. */
+    struct ChunkKey {
+        coord_t row;
+        coord_t col;
+
+        bool operator==(const ChunkKey &other) const {
+            return row == other.row && col == other.col;
+        }
+    };
+
+    struct ChunkKeyHash {
+        size_t operator()(const ChunkKey &key) const {
+            const std::uint64_t mixed = (std::uint64_t) key.row * 0x9E3779B97F4A7C15ULL ^ (std::uint64_t) key.col;
+            return std::hash<std::uint64_t>()(mixed);
+        }
+    };
+
+    struct Chunk {
+        cells_t cells{CHUNK_SIZE, CHUNK_SIZE};
+        size_t population = 0;  // count of non-dead cells
+    };
+
+    typedef std::unordered_map<ChunkKey, Chunk, ChunkKeyHash> chunks_t;
+
+    /* Working memory of a thread: a window of cells reaching r
+     * cells past a block of chunks on every side. */
+    struct Window {
+        cells_t cells, nextCells;
+        mask_t alive, nextAlive;
+        std::unique_ptr<NeighborCounter> counter;
+        std::vector<count_t> neighbors;
+        std::vector<std::pair<ChunkKey, Chunk>> nextChunks;
+        std::vector<ChunkKey> emptiedChunks;    // stored chunks with no cells left
+        std::vector<cells_t> spareCells;        // cells of replaced chunks, reused
+    };
+
+    const BoardArgs args;
+    RuleTable rules;
+    const RowKernels &kernels;
+    const size_t blockChunks;   // chunks per side of a block advanced at once
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<Window> windows;
+    chunks_t chunks;
+
+public:
+
+    /* Creates an empty board with rules given by boardArgs; its
+     * size and wrapped edges are not used. */
+    explicit SparseBoard(BoardArgs boardArgs);
+
+    /* Advances the board by a single generation. */
+    void update();
+
+    /* Advances the board by 'generations' generations. */
+    void step(size_t generations);
+
+    /* Returns the state of the cell at the given position. */
+    cell_t getCell(coord_t row, coord_t col) const;
+
+    /* Sets the state of the cell at the given position. */
+    void setCell(coord_t row, coord_t col, cell_t state);
+
+    /* Copies the cells onto the board, with the first of
+     * them at row 'top' and column 'left'. */
+    void setCells(coord_t top, coord_t left, const cells_t &region);
+
+    /* Returns cells of 'height' rows and 'width' columns
+     * starting at row 'top' and column 'left'. */
+    cells_t getRegion(coord_t top, coord_t left, size_t height, size_t width) const;
+
+    /* Returns the smallest rectangle holding all non-dead cells;
+     * it is empty (all coordinates zero) if there are none. */
+    BoundingBox getBoundingBox() const;
+
+    /* Returns the count of non-dead cells. */
+    size_t getPopulation() const;
+
+    /* Returns the count of chunks currently allocated. */
+    size_t getChunkCount() const;
+
+private:
+
+    /* Copies cells of the chunks into 'target', which is filled
+     * with cells starting at row 'top' and column 'left'. */
+    void copyChunks(coord_t top, coord_t left, cells_t &target) const;
+
+    /* Advances the chunks of a block a single generation. Chunks
+     * not empty afterwards are added to the next chunks of the
+     * window, and stored chunks left empty to its emptied chunks. */
+    void advanceBlock(Window &window, const ChunkKey &block) const;
+
+    /* Moves the next chunks of a window into the stored chunks and
+     * removes its emptied chunks; cells of both go to its spares. */
+    void mergeChunks(Window &window);
+};
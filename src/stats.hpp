@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "board.hpp"
+
+/* Copies of the histogram of changes kept by every band, used by
+ * cells in turn, so that runs of cells of the same state do not
+ * wait for each other to update their count. */
+const size_t STATS_HISTOGRAM_LANES = 4;
+
+/* Changes of the statistics of a board, gathered by the engines
+ * while they write the next generation. Every band of rows has
+ * its own, and owns the live counts of its rows. Changes wrap
+ * around when counts drop, and come back to the right value once
+ * they are added to the counts of the board. */
+struct StatsDelta {
+    std::vector<size_t> histogram;  // change of the count of cells in every state, per lane
+    std::vector<size_t> colCounts;  // change of live cells per column, or per mask word
+    size_t *rowCounts = nullptr;    // live cells per row of the board
+    size_t bitIndexSum = 0;         // change of the sum of bit indices of live cells, per mask word
+};
+
+/* Adds the changes of 'count' cells of a row, starting at column
+ * 'firstCol', from 'lastCells' to 'nextCells' to the delta. Apart
+ * from skipped runs, cells are tallied without branches, as their
+ * changes are hard to predict. */
+inline void addCellsDelta(const cell_t *lastCells, const cell_t *nextCells, size_t row, size_t firstCol,
+                          size_t count, StatsDelta &delta) {
+    const size_t states = delta.histogram.size() / STATS_HISTOGRAM_LANES;
+    size_t *histogram = delta.histogram.data();
+    size_t *colCounts = delta.colCounts.data() + firstCol;
+    size_t liveStep = 0;
+    for (size_t col = 0; col < count; ++col) {
+        // unchanged runs of 8 cells are skipped at once
+        std::uint64_t chunk, lastChunk;
+        if (col % sizeof(chunk) == 0 && col + sizeof(chunk) <= count) {
+            std::memcpy(&chunk, nextCells + col, sizeof(chunk));
+            std::memcpy(&lastChunk, lastCells + col, sizeof(chunk));
+            if (chunk == lastChunk) {
+                col += sizeof(chunk) - 1;
+                continue;
+            }
+        }
+        const cell_t state = nextCells[col], lastState = lastCells[col];
+        size_t *lane = histogram + (col % STATS_HISTOGRAM_LANES) * states;
+        ++lane[state];
+        --lane[lastState];
+        const size_t step = (size_t) (state != 0) - (size_t) (lastState != 0);
+        liveStep += step;
+        colCounts[col] += step;
+    }
+    delta.rowCounts[row] += liveStep;
+}
+
+/* Returns the sum of the indices of the bits set in a word:
+ * bit k of every index is summed by one count of set bits. */
+inline size_t getBitIndexSum(mask_word_t bits) {
+    const mask_word_t indexBits[] = {0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0,
+                                     0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000};
+    size_t sum = 0;
+    for (size_t bit = 0; bit < sizeof(indexBits) / sizeof(indexBits[0]); ++bit)
+        sum += (size_t) __builtin_popcountll(bits & indexBits[bit]) << bit;
+    return sum;
+}
+
+/* Adds the change of a word of the alive mask of two-state
+ * rules from 'lastBits' to 'bits' to the delta. */
+inline void addWordDelta(mask_word_t lastBits, mask_word_t bits, size_t row, size_t word, StatsDelta &delta) {
+    if (bits == lastBits) return;
+    const mask_word_t born = bits & ~lastBits, died = lastBits & ~bits;
+    const size_t step = (size_t) __builtin_popcountll(born) - (size_t) __builtin_popcountll(died);
+    delta.histogram[1] += step;
+    delta.histogram[0] -= step;
+    delta.rowCounts[row] += step;
+    delta.colCounts[word] += step;
+    delta.bitIndexSum += getBitIndexSum(born) - getBitIndexSum(died);
+}
@@ -0,0 +1,86 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads) {
+    for (size_t i = 1; i < threads; ++i)
+        workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::run(size_t count, const std::function<void(size_t)> &batchTask) {
+    if (workers.empty() || count <= 1) {
+        for (size_t index = 0; index < count; ++index)
+            batchTask(index);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &batchTask;
+        taskCount = count;
+        nextIndex = 0;
+        busyWorkers = workers.size();
+        ++batch;
+    }
+    wakeUp.notify_all();
+
+    // the calling thread takes its share of the work too
+    runTasks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return busyWorkers == 0; });
+    task = nullptr;
+}
+
+void ThreadPool::work() {
+    unsigned long long seenBatch = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [&] { return isStopping || batch != seenBatch; });
+            if (isStopping)
+                return;
+            seenBatch = batch;
+        }
+
+        runTasks();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0)
+            finished.notify_one();
+    }
+}
+
+void ThreadPool::runTasks() {
+    for (size_t index = nextIndex++; index < taskCount; index = nextIndex++)
+        (*task)(index);
+}
+
+
+size_t getBandCount(const ThreadPool *pool, size_t rows) {
+    const size_t threads = pool ? pool->getThreadCount() : 1;
+    return std::min(threads, rows);
+}
+
+void forEachBand(ThreadPool *pool, size_t rows,
+                 const std::function<void(size_t band, size_t first, size_t last)> &task) {
+    const size_t bands = getBandCount(pool, rows);
+    auto runBand = [&](size_t band) {
+        task(band, getBandStart(rows, bands, band), getBandStart(rows, bands, band + 1));
+    };
+
+    if (pool)
+        pool->run(bands, runBand);
+    else
+        for (size_t band = 0; band < bands; ++band)
+            runBand(band);
+}
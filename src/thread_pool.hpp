@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <cstddef>
+
+/* Fixed set of worker threads, started once and kept waiting
+ * between calls, so that no threads are spawned per generation. */
+class ThreadPool {
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeUp;     // signals a new batch or stopping
+    std::condition_variable finished;   // signals that workers are done
+
+    const std::function<void(size_t)> *task = nullptr;  // task of the current batch
+    size_t taskCount = 0;                 // count of task calls in the batch
+    std::atomic<size_t> nextIndex{0};     // next task index to be taken
+    size_t busyWorkers = 0;               // workers still inside the batch
+    unsigned long long batch = 0;         // incremented for every batch
+    bool isStopping = false;
+
+public:
+
+    /* Creates a pool running tasks on 'threads' threads in total,
+     * the thread calling run() included. A pool of one thread
+     * starts no workers and runs everything in place. */
+    explicit ThreadPool(size_t threads);
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool();
+
+    /* Returns the count of threads running tasks. */
+    size_t getThreadCount() const { return workers.size() + 1; }
+
+    /* Calls task(index) for every index below 'count', spread over
+     * the threads of the pool, and returns once all calls have
+     * finished. The task must not throw. */
+    void run(size_t count, const std::function<void(size_t)> &task);
+
+private:
+
+    /* Loop of a worker thread, waiting for batches of tasks. */
+    void work();
+
+    /* Takes indices of the current batch until none are left. */
+    void runTasks();
+};
+
+
+/* Returns the first row of a band, out of 'bands' equal bands
+ * splitting rows [0, rows). */
+inline size_t getBandStart(size_t rows, size_t bands, size_t band) {
+    return rows * band / bands;
+}
+
+/* Splits rows [0, rows) into equal bands, one per thread of the
+ * pool (a single band without a pool), and calls task(band, first,
+ * last) for the rows [first, last) of each band in parallel. */
+void forEachBand(ThreadPool *pool, size_t rows,
+                 const std::function<void(size_t band, size_t first, size_t last)> &task);
+
+/* Returns the count of bands forEachBand() splits the rows into. */
+size_t getBandCount(const ThreadPool *pool, size_t rows);
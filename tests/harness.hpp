@@ -0,0 +1,16 @@
+#pragma once
+#include <catch2/catch_all.hpp>
+#include "helpers.hpp"
+
+/* Runs a board from 'start' side by side with another engine, and
+ * checks that the cells match after every call of 'advance', which
+ * moves the engine 'depth' generations on and returns its cells. */
+template<typename Advance>
+void requireSameAsUpdates(const BoardArgs &args, const cells_t &start, int calls, size_t depth, Advance advance) {
+    auto board = Board(args, start);
+    for (int call = 0; call < calls; ++call) {
+        for (size_t generation = 0; generation < depth; ++generation)
+            board.update();
+        REQUIRE(equalCells(advance(), board.getCells()));
+    }
+}
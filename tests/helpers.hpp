@@ -0,0 +1,65 @@
+#pragma once
+#include <random>
+#include <algorithm>
+#include <cstddef>
+#include "../src/board.hpp"
+
+/* Cell factories and comparisons shared by the tests. */
+
+/* Returns cells of given dimensions, each of them fully
+ * alive with the given probability. */
+inline cells_t randomCells(size_t height, size_t width, double density, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::bernoulli_distribution alive(density);
+    cells_t cells(height, width);
+    for (size_t row = 0; row < height; ++row)
+        for (size_t col = 0; col < width; ++col)
+            cells[row][col] = alive(generator) ? 1 : 0;
+    return cells;
+}
+
+/* Returns cells of given dimensions, each of them in a random
+ * state below 'states' with the given probability, and dead
+ * otherwise. */
+inline cells_t randomStateCells(size_t height, size_t width, int states, double density, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::bernoulli_distribution live(density);
+    std::uniform_int_distribution<int> state(1, states - 1);
+    cells_t cells(height, width);
+    for (size_t row = 0; row < height; ++row)
+        for (size_t col = 0; col < width; ++col)
+            cells[row][col] = live(generator) ? (cell_t) state(generator) : 0;
+    return cells;
+}
+
+/* Copies all of 'patch' into 'cells', with its top left
+ * corner at row 'top' and column 'left'. */
+inline void placeCells(const cells_t &patch, cells_t &cells, size_t top, size_t left) {
+    for (size_t row = 0; row < patch.getHeight(); ++row)
+        std::copy(patch[row], patch[row] + patch.getWidth(), cells[top + row] + left);
+}
+
+/* Returns cells in state 1 where bits of the alive mask are set,
+ * as bit-sliced boards of two-state rules have them. */
+inline cells_t maskCells(const mask_t &alive, size_t width) {
+    cells_t cells(alive.getHeight(), width);
+    for (size_t row = 0; row < alive.getHeight(); ++row)
+        for (size_t col = 0; col < width; ++col)
+            cells[row][col] = isMaskBitSet(alive[row], col) ? 1 : 0;
+    return cells;
+}
+
+/* Returns true if both grids have the same dimensions and values. */
+template<typename T>
+bool equalGrids(const Grid<T> &first, const Grid<T> &second) {
+    if (first.getHeight() != second.getHeight() || first.getWidth() != second.getWidth())
+        return false;
+    for (size_t row = 0; row < first.getHeight(); ++row)
+        if (!std::equal(first[row], first[row] + first.getWidth(), second[row]))
+            return false;
+    return true;
+}
+
+inline bool equalCells(const cells_t &first, const cells_t &second) {
+    return equalGrids(first, second);
+}
@@ -0,0 +1,86 @@
+#include <catch2/catch_all.hpp>
+#include "../src/blocking.hpp"
+#include "harness.hpp"
+
+
+/* Rows and mask words of the regions the tests advance at once. */
+const size_t TEST_REGION_ROWS = 16;
+const size_t TEST_REGION_WORDS = 1;
+
+/* Advances cells 'depth' generations with a blocker, a small
+ * region at a time, and checks that the cells and the alive mask
+ * match as many board updates. */
+void requireBlockedAsUpdates(const BoardArgs &args, ThreadPool *pool, size_t depth, unsigned seed) {
+    const cells_t start = randomCells(args.height, args.width, 0.3, seed);
+    TemporalBlocker blocker(args, pool);
+    requireSameAsUpdates(args, start, 1, depth, [&] {
+        mask_t alive, nextAlive(args.height, getMaskWords(args.width));
+        fillAliveMask(start, alive);
+        cells_t nextCells(args.height, args.width);
+        const size_t words = alive.getWidth();
+        forEachBand(pool, args.height, [&](size_t band, size_t first, size_t last) {
+            for (size_t row = first; row < last; row += TEST_REGION_ROWS)
+                for (size_t word = 0; word < words; word += TEST_REGION_WORDS)
+                    blocker.stepRegion(band, start, alive, nextCells, nextAlive, args.width,
+                                       row, std::min(row + TEST_REGION_ROWS, last),
+                                       word, std::min(word + TEST_REGION_WORDS, words), depth);
+        });
+
+        // cells are left out when rules are bit-sliced
+        if (BitSliceStepper::isSupported(args))
+            return maskCells(nextAlive, args.width);
+        mask_t expected;
+        fillAliveMask(nextCells, expected);
+        REQUIRE(equalGrids(nextAlive, expected));
+        return nextCells;
+    });
+}
+
+TEST_CASE("Blocked generations match single updates")
+{
+    BoardArgs args;
+    args.width = 75;
+    args.height = 61;
+    for (int states : {2, 3}) {
+        for (bool isMoore : {true, false}) {
+            for (int radius : {1, 2, 4}) {
+                args.states = states;
+                args.neighborhoodType = isMoore ? NeighborhoodType::MOORE : NeighborhoodType::VON_NEUMANN;
+                args.neighborhoodRadius = radius;
+                int area = (int) getNeighborhoodSize(args);
+                args.birthConds = {area / 4, area / 4 + 1, area / 3};
+                args.surviveConds = {area / 5, area / 4, area / 4 + 1, area / 3};
+                for (size_t depth : {1, 2, 5})
+                    requireBlockedAsUpdates(args, nullptr, depth, (unsigned) (radius + depth));
+            }
+        }
+    }
+}
+
+TEST_CASE("Blocked generations keep cells inside the board")
+{
+    BoardArgs args;
+    args.width = 40;
+    args.height = 50;
+    args.birthConds = {0, 1};
+    args.surviveConds = {0, 3, 4};
+    for (int states : {2, 3}) {
+        args.states = states;
+        requireBlockedAsUpdates(args, nullptr, 3, 9);
+    }
+}
+
+TEST_CASE("Blocked generations on many threads match single updates")
+{
+    BoardArgs args;
+    args.width = 70;
+    args.height = 100;
+    args.neighborhoodRadius = 2;
+    args.birthConds = {6, 7, 8};
+    args.surviveConds = {5, 6, 7, 8};
+    ThreadPool pool(3);
+    for (int states : {2, 5}) {
+        args.states = states;
+        requireBlockedAsUpdates(args, &pool, 4, 21);
+    }
+}
@@ -1,5 +1,14 @@
 #include <catch2/catch_all.hpp>
+#include <random>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <algorithm>
 #include "../src/board.hpp"
+#include "../src/bitslice.hpp"
+#include "../src/neighborhood.hpp"
+#include "harness.hpp"
 
 
 /* ---------  INVALID ARGUMENTS  --------- */
@@ -41,6 +50,17 @@ TEST_CASE("Create Board with states out of bounds")
     REQUIRE_THROWS_AS(Board(args), std::invalid_argument);
 }
 
+TEST_CASE("Create Board with thread count out of bounds")
+{
+    BoardArgs args;
+    args.surviveConds.insert(2);
+    args.birthConds.insert(2);
+    args.threads = THREADS_MIN-1;
+    REQUIRE_THROWS_AS(Board(args), std::invalid_argument);
+    args.threads = THREADS_MAX+1;
+    REQUIRE_THROWS_AS(Board(args), std::invalid_argument);
+}
+
 TEST_CASE("Create Board with empty birthConds")
 {
     BoardArgs args;
@@ -57,21 +77,65 @@ TEST_CASE("Create Board with empty surviveConds")
     REQUIRE_THROWS_AS(Board(args), std::invalid_argument);
 }
 
+TEST_CASE("Create Board with custom weights of a wrong size")
+{
+    BoardArgs args;
+    args.neighborhoodRadius = 2;
+    args.birthConds.insert(2);
+    args.surviveConds.insert(1);
+    args.neighborhoodType = NeighborhoodType::CUSTOM;
+    args.neighborhoodWeights.assign(9, 1);
+    REQUIRE_THROWS_AS(Board(args), std::invalid_argument);
+}
+
+TEST_CASE("Create Board with custom weights out of range")
+{
+    BoardArgs args;
+    args.birthConds.insert(2);
+    args.surviveConds.insert(1);
+    args.neighborhoodType = NeighborhoodType::CUSTOM;
+    args.neighborhoodWeights.assign(9, 1);
+    args.neighborhoodWeights[1] = -1;
+    REQUIRE_THROWS_AS(Board(args), std::invalid_argument);
+    args.neighborhoodWeights[1] = NEIGHBORHOOD_WEIGHT_MAX + 1;
+    REQUIRE_THROWS_AS(Board(args), std::invalid_argument);
+}
+
 TEST_CASE("Create Board with incorrect cell values")
 {
     BoardArgs args;
     args.birthConds.insert(2);
     args.surviveConds.insert(1);
 
-    cells_t cells;
-    for (size_t row = 0; row < cells.size(); ++row) {
-        for (size_t col = 0; col < cells[0].size(); ++col) {
+    cells_t cells(BOARD_SIZE, BOARD_SIZE);
+    for (size_t row = 0; row < cells.getHeight(); ++row) {
+        for (size_t col = 0; col < cells.getWidth(); ++col) {
             cells[row][col] = 3;
         }
     }
     REQUIRE_THROWS_AS(Board(args, cells), std::invalid_argument);
 }
 
+TEST_CASE("Create Board with zero width")
+{
+    BoardArgs args;
+    args.birthConds.insert(2);
+    args.surviveConds.insert(1);
+    args.width = 0;
+    REQUIRE_THROWS_AS(Board(args), std::invalid_argument);
+}
+
+TEST_CASE("Create Board with cells of a different size than in BoardArgs")
+{
+    BoardArgs args;
+    args.birthConds.insert(2);
+    args.surviveConds.insert(1);
+    args.width = 20;
+    args.height = 10;
+    REQUIRE_THROWS_AS(Board(args, cells_t(20, 10)), std::invalid_argument);
+    REQUIRE_THROWS_AS(Board(args, cells_t(10, 21)), std::invalid_argument);
+}
+
 /* ---------  INITIALIZATION  --------- */
 
 TEST_CASE("Constructor taking BoardArgs OK")
@@ -87,13 +151,36 @@ TEST_CASE("Constructor taking BoardArgs and cells_t OK")
     BoardArgs args;
     args.birthConds.insert(2);
     args.surviveConds.insert(1);
-    cells_t cells;
-    for (size_t row = 0; row < cells.size(); ++row) {
-        for (size_t col = 0; col < cells[0].size(); ++col) {
+    cells_t cells(BOARD_SIZE, BOARD_SIZE);
+    for (size_t row = 0; row < cells.getHeight(); ++row) {
+        for (size_t col = 0; col < cells.getWidth(); ++col) {
             cells[row][col] = (int)col % 2;
         }
     }
-    REQUIRE_NOTHROW(Board(args));
+    REQUIRE_NOTHROW(Board(args, cells));
+}
+
+TEST_CASE("Constructor taking non-square dimensions OK")
+{
+    BoardArgs args;
+    args.birthConds.insert(2);
+    args.surviveConds.insert(1);
+    args.width = 100;
+    args.height = 37;
+    auto board = Board(args);
+    REQUIRE(board.getWidth() == 100);
+    REQUIRE(board.getHeight() == 37);
+    REQUIRE(board.getCells().getWidth() == 100);
+    REQUIRE(board.getCells().getHeight() == 37);
+    REQUIRE_NOTHROW(board.update());
+}
+
+TEST_CASE("Cell rows are aligned to cache lines")
+{
+    cells_t cells(5, 17);
+    REQUIRE(cells.getStride() >= cells.getWidth());
+    for (size_t row = 0; row < cells.getHeight(); ++row)
+        REQUIRE(reinterpret_cast<uintptr_t>(cells[row]) % CACHE_LINE_SIZE == 0);
 }
 
 TEST_CASE("getSize returns correct size")
@@ -103,8 +190,8 @@ TEST_CASE("getSize returns correct size")
     args.surviveConds.insert(3);
     auto board = Board(args);
     REQUIRE(board.getSize() == BOARD_SIZE);
-    REQUIRE(board.getSize() == board.getCells().size());
-    REQUIRE(board.getSize() == board.getCells()[0].size());
+    REQUIRE(board.getSize() == board.getCells().getWidth());
+    REQUIRE(board.getSize() == board.getCells().getHeight());
 }
 
 TEST_CASE("Correct amount of alive cells initialized")
@@ -115,8 +202,10 @@ TEST_CASE("Correct amount of alive cells initialized")
     auto board = Board(args);
 
     int aliveCells = 0;
-    for (auto row : board.getCells()) {
-        for (auto cell : row) {
+    const auto &cells = board.getCells();
+    for (size_t row = 0; row < cells.getHeight(); ++row) {
+        for (size_t col = 0; col < cells.getWidth(); ++col) {
+            auto cell = cells[row][col];
             REQUIRE((cell == 0 || cell == 1));
             if (cell != 0)
                 ++aliveCells;
@@ -144,10 +233,10 @@ int calculateNeighbors(const cells_t &cells, const coords_t &coords) {
     if (col > 0 && cells[row][col-1] == 1)
         ++neighbors;
 
-    if (row < cells.size()-1 && cells[row+1][col] == 1)
+    if (row < cells.getHeight()-1 && cells[row+1][col] == 1)
         ++neighbors;
 
-    if (col < cells.size()-1 && cells[row][col+1] == 1)
+    if (col < cells.getWidth()-1 && cells[row][col+1] == 1)
         ++neighbors;
 
     return neighbors;
@@ -505,4 +594,890 @@ TEST_CASE("Cells state increases after update() is called - 256 states")
                 REQUIRE(cells[row][col] == 0);
         }
     }
-}
\ No newline at end of file
+}
+
+/* ---------  EQUIVALENCE WITH A NAIVE UPDATE  --------- */
+
+/* Returns how many times a cell at the given offsets from the
+ * center counts in the neighborhood, written from its definition. */
+int referenceWeight(const BoardArgs &args, long rowOffset, long colOffset) {
+    const long radius = args.neighborhoodRadius;
+    const long rowDistance = std::labs(rowOffset), colDistance = std::labs(colOffset);
+    switch (getNeighborhoodType(args)) {
+        case NeighborhoodType::MOORE:
+            return 1;
+        case NeighborhoodType::VON_NEUMANN:
+            return rowDistance + colDistance <= radius;
+        case NeighborhoodType::CIRCULAR:
+            return std::hypot((double) rowOffset, (double) colOffset) < radius + 0.5;
+        case NeighborhoodType::CHECKERBOARD:
+            return (rowDistance + colDistance) % 2 == 1;
+        case NeighborhoodType::CROSS:
+            return rowDistance == 0 || colDistance == 0;
+        case NeighborhoodType::HASH:
+            return rowDistance == 1 || colDistance == 1;
+        case NeighborhoodType::CUSTOM:
+            return args.neighborhoodWeights[(size_t) ((rowOffset + radius) * (2 * radius + 1) + colOffset + radius)];
+    }
+    return 0;
+}
+
+/* Straightforward implementation of a single generation,
+ * used as a reference for the optimized engines. */
+void referenceUpdate(const BoardArgs &args, cells_t &cells) {
+    const cells_t previous = cells;
+    const long height = (long) cells.getHeight();
+    const long width = (long) cells.getWidth();
+    const long radius = args.neighborhoodRadius;
+
+    for (long row = 0; row < height; ++row) {
+        for (long col = 0; col < width; ++col) {
+            int neighbors = 0;
+            for (long i = row - radius; i <= row + radius; ++i) {
+                for (long j = col - radius; j <= col + radius; ++j) {
+                    const long wrappedRow = args.isWrappedVertically ? (i % height + height) % height : i;
+                    const long wrappedCol = args.isWrappedHorizontally ? (j % width + width) % width : j;
+                    if (wrappedRow < 0 || wrappedCol < 0 || wrappedRow >= height || wrappedCol >= width)
+                        continue;
+                    if (i == row && j == col) {
+                        neighbors += args.isIncludeCenter && previous[row][col] == 1;
+                        continue;
+                    }
+                    if (previous[wrappedRow][wrappedCol] == 1)
+                        neighbors += referenceWeight(args, i - row, j - col);
+                }
+            }
+
+            cell_t state = previous[row][col];
+            if (state == 0) {
+                if (args.birthConds.count(neighbors))
+                    cells[row][col] = 1;
+            }
+            else if (state > 1 || !args.surviveConds.count(neighbors)) {
+                cells[row][col] = (state + 1 == args.states ? 0 : state + 1);
+            }
+        }
+    }
+}
+
+/* Runs a board and the reference update side by side
+ * and checks that every generation matches. */
+void requireSameAsReference(BoardArgs args, double density, int generations, unsigned seed) {
+    cells_t expected = randomCells(args.height, args.width, density, seed);
+    requireSameAsUpdates(args, expected, generations, 1, [&args, &expected]() {
+        referenceUpdate(args, expected);
+        return expected;
+    });
+}
+
+TEST_CASE("Moore neighborhood matches the naive update")
+{
+    BoardArgs args;
+    args.width = 41;
+    args.height = 29;
+    args.neighborhoodType = NeighborhoodType::MOORE;
+    args.states = 4;
+
+    for (int radius : {1, 2, 5, 9}) {
+        for (bool includeCenter : {false, true}) {
+            args.neighborhoodRadius = radius;
+            args.isIncludeCenter = includeCenter;
+            int area = (2 * radius + 1) * (2 * radius + 1);
+            args.birthConds = {area / 4, area / 4 + 1, area / 3};
+            args.surviveConds = {area / 5, area / 4, area / 4 + 2, area / 3};
+            requireSameAsReference(args, 0.3, 6, (unsigned) radius);
+        }
+    }
+}
+
+TEST_CASE("Moore neighborhood larger than the board matches the naive update")
+{
+    BoardArgs args;
+    args.width = 7;
+    args.height = 12;
+    args.neighborhoodRadius = 15;
+    args.states = 3;
+    args.birthConds = {10, 11, 12, 13, 14, 15};
+    args.surviveConds = {8, 9, 10, 11, 12};
+    requireSameAsReference(args, 0.2, 5, 3);
+}
+
+TEST_CASE("Von Neumann neighborhood matches the naive update")
+{
+    BoardArgs args;
+    args.width = 33;
+    args.height = 40;
+    args.neighborhoodType = NeighborhoodType::VON_NEUMANN;
+    args.states = 5;
+
+    for (int radius : {1, 3, 6, 10}) {
+        for (bool includeCenter : {false, true}) {
+            args.neighborhoodRadius = radius;
+            args.isIncludeCenter = includeCenter;
+            int area = 2 * radius * (radius + 1) + 1;
+            args.birthConds = {area / 4, area / 4 + 1, area / 3};
+            args.surviveConds = {area / 5, area / 4, area / 4 + 2, area / 3};
+            requireSameAsReference(args, 0.3, 6, (unsigned) radius);
+        }
+    }
+}
+
+/* Returns random weights of a custom neighborhood of the radius. */
+std::vector<int> randomWeights(int radius, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> dist(0, 3);
+    std::vector<int> weights((size_t) ((2 * radius + 1) * (2 * radius + 1)));
+    for (int &weight : weights)
+        weight = dist(generator);
+    return weights;
+}
+
+TEST_CASE("Extended neighborhood shapes match the naive update")
+{
+    BoardArgs args;
+    args.width = 45;
+    args.height = 31;
+
+    for (NeighborhoodType type : {NeighborhoodType::CIRCULAR, NeighborhoodType::CHECKERBOARD,
+                                  NeighborhoodType::CROSS, NeighborhoodType::HASH, NeighborhoodType::CUSTOM}) {
+        for (int radius : {1, 3, 7}) {
+            for (int states : {2, 4}) {
+                for (int edges = 0; edges < 4; ++edges) {
+                    args.neighborhoodType = type;
+                    args.neighborhoodRadius = radius;
+                    args.neighborhoodWeights = randomWeights(radius, (unsigned) (radius + edges));
+                    args.states = states;
+                    args.isIncludeCenter = edges & 1;
+                    args.isWrappedHorizontally = edges & 1;
+                    args.isWrappedVertically = edges & 2;
+                    int area = (int) getNeighborhoodSize(args);
+                    args.birthConds = {area / 4, area / 4 + 1, area / 3};
+                    args.surviveConds = {area / 5, area / 4, area / 4 + 1, area / 3};
+                    requireSameAsReference(args, 0.3, 5, (unsigned) (states + radius + edges));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Sizes of extended neighborhoods")
+{
+    BoardArgs args;
+    args.neighborhoodRadius = 2;
+    args.isIncludeCenter = false;
+    args.neighborhoodType = NeighborhoodType::CIRCULAR;
+    REQUIRE(getNeighborhoodSize(args) == 20);
+    args.neighborhoodType = NeighborhoodType::CHECKERBOARD;
+    REQUIRE(getNeighborhoodSize(args) == 12);
+    args.neighborhoodType = NeighborhoodType::CROSS;
+    REQUIRE(getNeighborhoodSize(args) == 8);
+    args.neighborhoodType = NeighborhoodType::HASH;
+    REQUIRE(getNeighborhoodSize(args) == 16);
+    args.isIncludeCenter = true;
+    REQUIRE(getNeighborhoodSize(args) == 17);
+}
+
+TEST_CASE("Unreachable conditions are ignored")
+{
+    BoardArgs args;
+    args.width = 30;
+    args.height = 30;
+    args.neighborhoodRadius = 1;
+    args.states = 3;
+    args.birthConds = {-4, 3, 9, 1000};
+    args.surviveConds = {-1, 2, 3, 8, 9};
+    requireSameAsReference(args, 0.35, 8, 7);
+
+    args.isIncludeCenter = true;
+    requireSameAsReference(args, 0.35, 8, 8);
+}
+
+TEST_CASE("Shared cells stay in place and follow updates while held")
+{
+    BoardArgs args;
+    args.width = 100;
+    args.height = 70;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    for (int states : {2, 3}) {
+        args.states = states;
+        cells_t expected = randomCells(args.height, args.width, 0.3, 12);
+        auto board = Board(args, expected);
+        const cells_t &shared = board.acquireSharedCells();
+        const cell_t *data = shared.data();
+        for (int generation = 0; generation < 3; ++generation) {
+            REQUIRE(equalCells(shared, expected));
+            board.update();
+            referenceUpdate(args, expected);
+            REQUIRE(shared.data() == data);
+        }
+        REQUIRE(equalCells(shared, expected));
+
+        board.step(5);
+        for (int generation = 0; generation < 5; ++generation)
+            referenceUpdate(args, expected);
+        REQUIRE(shared.data() == data);
+        REQUIRE(equalCells(shared, expected));
+
+        // released cells are left behind, until held again
+        const cells_t held = shared;
+        board.releaseSharedCells();
+        board.update();
+        referenceUpdate(args, expected);
+        REQUIRE(equalCells(shared, held));
+        REQUIRE(&board.acquireSharedCells() == &shared);
+        REQUIRE(shared.data() == data);
+        REQUIRE(equalCells(shared, expected));
+    }
+}
+
+TEST_CASE("Alive mask marks state 1 cells after every update")
+{
+    BoardArgs args;
+    args.width = 130;
+    args.height = 9;
+    args.neighborhoodRadius = 2;
+    args.states = 6;
+    args.birthConds = {3, 4, 5};
+    args.surviveConds = {4, 5, 6};
+    auto board = Board(args, randomCells(args.height, args.width, 0.3, 11));
+
+    for (int generation = 0; generation < 5; ++generation) {
+        const auto &cells = board.getCells();
+        const auto &mask = board.getAliveMask();
+        REQUIRE(mask.getHeight() == cells.getHeight());
+        REQUIRE(mask.getWidth() == getMaskWords(cells.getWidth()));
+        for (size_t row = 0; row < cells.getHeight(); ++row) {
+            for (size_t col = 0; col < cells.getWidth(); ++col)
+                REQUIRE(isMaskBitSet(mask[row], col) == (cells[row][col] == 1));
+            // bits past the last column stay clear
+            REQUIRE((mask[row][mask.getWidth() - 1] >> (cells.getWidth() % MASK_WORD_BITS)) == 0);
+        }
+        board.update();
+    }
+}
+
+TEST_CASE("Two-state rules match the naive update")
+{
+    BoardArgs args;
+    args.states = 2;
+
+    for (size_t width : {37, 64, 150}) {
+        for (int radius : {1, 2, 5, BITSLICE_RADIUS_MAX}) {
+            for (bool isMoore : {true, false}) {
+                for (bool includeCenter : {false, true}) {
+                    args.width = width;
+                    args.height = 23;
+                    args.neighborhoodRadius = radius;
+                    args.neighborhoodType = isMoore ? NeighborhoodType::MOORE : NeighborhoodType::VON_NEUMANN;
+                    args.isIncludeCenter = includeCenter;
+                    int area = (int) getNeighborhoodSize(args);
+                    args.birthConds = {area / 4, area / 4 + 1, area / 3};
+                    args.surviveConds = {area / 5, area / 4, area / 4 + 1, area / 3};
+                    requireSameAsReference(args, 0.3, 4, (unsigned) (width + radius));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Two-state rules of every bit-sliced radius match the naive update")
+{
+    BoardArgs args;
+    args.width = 70;
+    args.height = 15;
+    args.states = 2;
+
+    for (int radius = 1; radius <= BITSLICE_RADIUS_MAX; ++radius) {
+        for (bool isMoore : {true, false}) {
+            args.neighborhoodRadius = radius;
+            args.neighborhoodType = isMoore ? NeighborhoodType::MOORE : NeighborhoodType::VON_NEUMANN;
+            int area = (int) getNeighborhoodSize(args);
+            args.birthConds = {area / 4, area / 4 + 1, area / 3};
+            args.surviveConds = {area / 5, area / 4, area / 4 + 1, area / 3};
+            requireSameAsReference(args, 0.3, 2, (unsigned) radius);
+        }
+    }
+}
+
+TEST_CASE("Two-state rules with birth on zero neighbors keep cells inside the board")
+{
+    BoardArgs args;
+    args.width = 70;
+    args.height = 11;
+    args.states = 2;
+    args.birthConds = {0, 1};
+    args.surviveConds = {0, 3, 4};
+    requireSameAsReference(args, 0.1, 3, 5);
+}
+
+/* Runs boards with one and with several threads side by side
+ * and checks that every generation is the same. */
+void requireSameAsSerial(BoardArgs args, int threads, int generations, unsigned seed) {
+    const cells_t start = randomCells(args.height, args.width, 0.3, seed);
+    BoardArgs threadedArgs = args;
+    threadedArgs.threads = threads;
+    auto threadedBoard = Board(threadedArgs, start);
+    requireSameAsUpdates(args, start, generations, 1, [&threadedBoard]() {
+        threadedBoard.update();
+        return threadedBoard.getCells();
+    });
+}
+
+TEST_CASE("Threaded updates match the serial update")
+{
+    BoardArgs args;
+    args.width = 90;
+    for (int states : {2, 4}) {
+        for (bool isMoore : {true, false}) {
+            for (int radius : {1, 3, 12}) {
+                args.states = states;
+                args.neighborhoodType = isMoore ? NeighborhoodType::MOORE : NeighborhoodType::VON_NEUMANN;
+                args.neighborhoodRadius = radius;
+                int area = (int) getNeighborhoodSize(args);
+                args.birthConds = {area / 4, area / 4 + 1, area / 3};
+                args.surviveConds = {area / 5, area / 4, area / 4 + 1, area / 3};
+                for (size_t height : {1, 5, 47}) {
+                    args.height = height;
+                    for (int threads : {2, 3, 8})
+                        requireSameAsSerial(args, threads, 4, (unsigned) (height + radius));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Wrapped edges match the naive update")
+{
+    BoardArgs args;
+    args.width = 75;
+    args.height = 21;
+
+    for (int states : {2, 4}) {
+        for (int radius : {1, 3, 7}) {
+            for (bool isMoore : {true, false}) {
+                for (int edges = 1; edges < 4; ++edges) {
+                    args.states = states;
+                    args.neighborhoodRadius = radius;
+                    args.neighborhoodType = isMoore ? NeighborhoodType::MOORE : NeighborhoodType::VON_NEUMANN;
+                    args.isWrappedHorizontally = edges & 1;
+                    args.isWrappedVertically = edges & 2;
+                    int area = (int) getNeighborhoodSize(args);
+                    args.birthConds = {area / 4, area / 4 + 1, area / 3};
+                    args.surviveConds = {area / 5, area / 4, area / 4 + 1, area / 3};
+                    requireSameAsReference(args, 0.3, 4, (unsigned) (states + radius + edges));
+                    requireSameAsSerial(args, 3, 3, (unsigned) (states + radius + edges));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Wrapped neighborhood larger than the board matches the naive update")
+{
+    BoardArgs args;
+    args.width = 7;
+    args.height = 12;
+    args.isWrappedHorizontally = true;
+    args.isWrappedVertically = true;
+    args.isIncludeCenter = true;
+    args.birthConds = {60, 61, 62, 63, 64, 65};
+    args.surviveConds = {55, 56, 57, 58, 59, 60};
+    for (int states : {2, 3}) {
+        for (int radius : {8, 15}) {
+            args.states = states;
+            args.neighborhoodRadius = radius;
+            requireSameAsReference(args, 0.2, 5, (unsigned) (states + radius));
+        }
+    }
+}
+
+TEST_CASE("Gliders cross wrapped edges")
+{
+    BoardArgs args;
+    args.width = 10;
+    args.height = 10;
+    args.isWrappedHorizontally = true;
+    args.isWrappedVertically = true;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    cells_t start(args.height, args.width);
+    start[0][1] = start[1][2] = start[2][0] = start[2][1] = start[2][2] = 1;
+
+    // a glider moves one cell down and right every 4 generations
+    auto board = Board(args, start);
+    board.step(40);
+    REQUIRE(equalCells(board.getCells(), start));
+}
+
+TEST_CASE("step() matches as many calls to update()")
+{
+    BoardArgs args;
+    args.width = 64;
+    args.birthConds = {3, 4};
+    args.surviveConds = {2, 3, 4};
+    for (int states : {2, 3}) {
+        for (size_t height : {20, 3000}) {
+            args.states = states;
+            args.height = height;
+            cells_t start = randomCells(args.height, args.width, 0.3, (unsigned) height);
+            auto stepped = Board(args, start);
+            auto updated = Board(args, start);
+
+            stepped.step(0);
+            REQUIRE(equalCells(stepped.getCells(), start));
+            for (size_t generations : {1, 7, 40}) {
+                stepped.step(generations);
+                for (size_t generation = 0; generation < generations; ++generation)
+                    updated.update();
+                REQUIRE(equalCells(stepped.getCells(), updated.getCells()));
+            }
+        }
+    }
+}
+
+/* Returns a dead board with a few random patches of cells. */
+cells_t sparseCells(size_t height, size_t width, size_t patchSize, unsigned seed) {
+    cells_t cells(height, width);
+    const cells_t patch = randomCells(patchSize, patchSize, 0.4, seed);
+    const size_t corners[][2] = {{0, 0}, {height / 2, width / 3}, {height - patchSize, width - patchSize}};
+    for (const auto &corner : corners)
+        placeCells(patch, cells, corner[0], corner[1]);
+    return cells;
+}
+
+TEST_CASE("Tiles far from changes are skipped")
+{
+    BoardArgs args;
+    args.width = 3000;
+    args.height = 256;
+    for (int states : {2, 3}) {
+        for (int radius : {1, 3}) {
+            args.states = states;
+            args.neighborhoodRadius = radius;
+            args.threads = radius;
+            int area = (int) getNeighborhoodSize(args);
+            args.birthConds = {area / 3, area / 3 + 1};
+            args.surviveConds = {area / 4, area / 3, area / 3 + 1};
+
+            cells_t expected = sparseCells(args.height, args.width, 20, (unsigned) (states + radius));
+            auto board = Board(args, expected);
+            REQUIRE(board.getTileCount() == 8 * 12);
+            for (int generation = 0; generation < 6; ++generation) {
+                board.update();
+                referenceUpdate(args, expected);
+                REQUIRE(equalCells(board.getCells(), expected));
+                if (generation > 0)
+                    REQUIRE(board.getActiveTileCount() < board.getTileCount());
+            }
+        }
+    }
+}
+
+TEST_CASE("Still boards have no active tiles")
+{
+    BoardArgs args;
+    args.width = 700;
+    args.height = 100;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    cells_t cells(args.height, args.width);
+    // a block is a still life
+    cells[40][300] = cells[40][301] = cells[41][300] = cells[41][301] = 1;
+    auto board = Board(args, cells);
+
+    // nothing is known about the start state
+    board.update();
+    REQUIRE(board.getActiveTileCount() == board.getTileCount());
+    for (int generation = 0; generation < 3; ++generation) {
+        board.update();
+        REQUIRE(board.getActiveTileCount() == 0);
+    }
+    REQUIRE(equalCells(board.getCells(), cells));
+}
+
+/* Checks that the changes recorded by the board lead from
+ * the cells of 'last' to its current cells, in row-major order,
+ * and then updates 'last' to the current cells. */
+void requireChangesLeadTo(const Board &board, cells_t &last) {
+    const auto &changes = board.getChanges();
+    for (size_t index = 0; index < changes.size(); ++index) {
+        const CellChange &change = changes[index];
+        REQUIRE(last[change.row][change.col] != change.state);
+        if (index > 0)
+            REQUIRE((changes[index - 1].row < change.row
+                    || (changes[index - 1].row == change.row && changes[index - 1].col < change.col)));
+        last[change.row][change.col] = (cell_t) change.state;
+    }
+    REQUIRE(equalCells(last, board.getCells()));
+}
+
+TEST_CASE("Changes recorded by updates lead to the next generation")
+{
+    BoardArgs args;
+    args.width = 600;
+    args.height = 100;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    for (int states : {2, 3}) {
+        for (bool isWrapped : {false, true}) {
+            args.states = states;
+            args.isWrappedHorizontally = args.isWrappedVertically = isWrapped;
+            for (bool isSparse : {false, true}) {
+                // sparse boards have tiles skipped by updates
+                cells_t last = isSparse ? sparseCells(args.height, args.width, 20, 13)
+                                        : randomCells(args.height, args.width, 0.3, 13);
+                auto board = Board(args, last);
+                board.recordChanges(true);
+                REQUIRE(board.getChanges().empty());
+                for (int generation = 0; generation < 5; ++generation) {
+                    board.update();
+                    requireChangesLeadTo(board, last);
+                }
+                REQUIRE(!board.getChanges().empty());
+
+                board.step(7);
+                requireChangesLeadTo(board, last);
+                board.step(0);
+                REQUIRE(board.getChanges().empty());
+
+                board.recordChanges(false);
+                board.update();
+                REQUIRE(board.getChanges().empty());
+            }
+        }
+    }
+}
+
+TEST_CASE("Still boards record no changes")
+{
+    BoardArgs args;
+    args.width = 200;
+    args.height = 50;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    cells_t cells(args.height, args.width);
+    cells[20][100] = cells[20][101] = cells[21][100] = cells[21][101] = 1;
+    auto board = Board(args, cells);
+    board.recordChanges(true);
+    board.update();
+    REQUIRE(board.getChanges().empty());
+    board.step(100);
+    REQUIRE(board.getChanges().empty());
+}
+
+/* Checks the transitions and population recorded by the board
+ * against the cells of 'last' and its current cells, and then
+ * updates 'last' to the current cells. */
+void requireMetricsMatch(const Board &board, cells_t &last) {
+    const GenerationMetrics &metrics = board.getMetrics();
+    const cells_t &cells = board.getCells();
+    size_t births = 0, deaths = 0, agings = 0, population = 0;
+    for (size_t row = 0; row < cells.getHeight(); ++row) {
+        for (size_t col = 0; col < cells.getWidth(); ++col) {
+            population += cells[row][col] == 1;
+            if (cells[row][col] == last[row][col]) continue;
+            births += cells[row][col] == 1;
+            deaths += cells[row][col] == 0;
+            agings += cells[row][col] > 1;
+        }
+    }
+    REQUIRE(metrics.births == births);
+    REQUIRE(metrics.deaths == deaths);
+    REQUIRE(metrics.agings == agings);
+    REQUIRE(metrics.population == population);
+    REQUIRE(metrics.cellsSkipped <= metrics.generations * cells.getHeight() * cells.getWidth());
+    REQUIRE(metrics.countSeconds >= 0);
+    REQUIRE(metrics.transitionSeconds >= 0);
+    REQUIRE(metrics.copySeconds >= 0);
+    REQUIRE(metrics.countSeconds + metrics.transitionSeconds + metrics.copySeconds <= metrics.totalSeconds * 1.001);
+    last = cells;
+}
+
+TEST_CASE("Metrics count the transitions of updates and steps")
+{
+    BoardArgs args;
+    args.width = 1000;
+    args.height = 160;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    for (int states : {2, 3, 5}) {
+        for (bool isWrapped : {false, true}) {
+            args.states = states;
+            args.isWrappedHorizontally = isWrapped;
+            for (bool isSparse : {false, true}) {
+                cells_t last = isSparse ? sparseCells(args.height, args.width, 20, 5)
+                                        : randomCells(args.height, args.width, 0.3, 5);
+                auto board = Board(args, last);
+                board.recordMetrics(true);
+                size_t skipped = 0;
+                for (int generation = 0; generation < 8; ++generation) {
+                    board.update();
+                    REQUIRE(board.getMetrics().generations == 1);
+                    requireMetricsMatch(board, last);
+                    skipped += board.getMetrics().cellsSkipped;
+                }
+                if (isSparse && !isWrapped)
+                    REQUIRE(skipped > 0);
+
+                board.step(6);
+                REQUIRE(board.getMetrics().generations == 6);
+                requireMetricsMatch(board, last);
+            }
+        }
+    }
+}
+
+TEST_CASE("Metrics stay zero while disabled")
+{
+    BoardArgs args;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    auto board = Board(args, randomCells(args.height, args.width, 0.3, 2));
+    board.update();
+    REQUIRE(board.getMetrics().generations == 0);
+    REQUIRE(board.getMetrics().totalSeconds == 0);
+
+    board.recordMetrics(true);
+    board.update();
+    REQUIRE(board.getMetrics().generations == 1);
+    REQUIRE(board.getMetrics().population > 0);
+    board.recordMetrics(false);
+    board.step(3);
+    REQUIRE(board.getMetrics().generations == 0);
+    REQUIRE(board.getMetrics().population == 0);
+}
+
+/* Checks the statistics kept by the board against
+ * statistics counted from its cells. */
+void requireStatsMatch(const Board &board) {
+    const BoardStats &stats = board.getStats();
+    const cells_t &cells = board.getCells();
+    std::vector<size_t> histogram(stats.histogram.size(), 0);
+    size_t liveCount = 0, top = cells.getHeight(), left = cells.getWidth(), bottom = 0, right = 0;
+    double rowSum = 0, colSum = 0;
+    for (size_t row = 0; row < cells.getHeight(); ++row) {
+        for (size_t col = 0; col < cells.getWidth(); ++col) {
+            ++histogram[cells[row][col]];
+            if (cells[row][col] == 0) continue;
+            ++liveCount;
+            top = std::min(top, row);
+            left = std::min(left, col);
+            bottom = std::max(bottom, row + 1);
+            right = std::max(right, col + 1);
+            rowSum += (double) row;
+            colSum += (double) col;
+        }
+    }
+    REQUIRE(stats.histogram == histogram);
+    REQUIRE(stats.liveCount == liveCount);
+    if (liveCount == 0) {
+        REQUIRE(stats.bottom == stats.top);
+        return;
+    }
+    REQUIRE(stats.top == top);
+    REQUIRE(stats.left == left);
+    REQUIRE(stats.bottom == bottom);
+    REQUIRE(stats.right == right);
+    REQUIRE(stats.centroidRow == rowSum / (double) liveCount);
+    REQUIRE(stats.centroidCol == colSum / (double) liveCount);
+}
+
+TEST_CASE("Statistics follow updates and steps")
+{
+    BoardArgs args;
+    args.width = 700;
+    args.height = 130;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    for (int states : {2, 3, 6}) {
+        for (bool isWrapped : {false, true}) {
+            args.states = states;
+            args.isWrappedVertically = isWrapped;
+            for (int threads : {1, 3}) {
+                // threaded boards also record metrics, which
+                // advance the rows of a band one by one
+                args.threads = threads;
+                for (bool isSparse : {false, true}) {
+                    auto board = Board(args, isSparse ? sparseCells(args.height, args.width, 20, 8)
+                                                      : randomCells(args.height, args.width, 0.3, 8));
+                    board.recordMetrics(threads > 1);
+                    board.recordStats(true);
+                    requireStatsMatch(board);
+                    for (int generation = 0; generation < 12; ++generation) {
+                        board.update();
+                        requireStatsMatch(board);
+                    }
+                    board.step(9);
+                    requireStatsMatch(board);
+                    board.update();
+                    requireStatsMatch(board);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Statistics of an empty board")
+{
+    BoardArgs args;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    cells_t cells(args.height, args.width);
+    cells[10][10] = 1;
+    auto board = Board(args, cells);
+    REQUIRE(board.getStats().histogram.empty());
+
+    board.recordStats(true);
+    REQUIRE(board.getStats().liveCount == 1);
+    REQUIRE(board.getStats().top == 10);
+    REQUIRE(board.getStats().right == 11);
+    board.update();
+    REQUIRE(board.getStats().liveCount == 0);
+    REQUIRE(board.getStats().histogram[0] == args.width * args.height);
+    REQUIRE(board.getStats().bottom == 0);
+
+    board.recordStats(false);
+    REQUIRE(board.getStats().histogram.empty());
+}
+
+TEST_CASE("Cycles of small patterns are found")
+{
+    BoardArgs args;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    for (int states : {2, 3}) {
+        args.states = states;
+        cells_t cells(args.height, args.width);
+        cells[10][10] = 1;
+        auto lonely = Board(args, cells);
+        lonely.trackCycles(true);
+        lonely.update();
+        lonely.update();
+        REQUIRE(lonely.getCycleReport().evolution == Evolution::EXTINCT);
+        REQUIRE(lonely.getCycleReport().period == 1);
+        REQUIRE(lonely.getCycleReport().generation == (states == 2 ? 1 : 2));
+
+        cells[10][11] = cells[11][10] = cells[11][11] = 1;
+        auto block = Board(args, cells);
+        block.trackCycles(true);
+        block.step(5);
+        REQUIRE(block.getCycleReport().evolution == Evolution::STILL_LIFE);
+        REQUIRE(block.getCycleReport().period == 1);
+        REQUIRE(block.getCycleReport().generation == 1);
+        REQUIRE(block.getGeneration() == 5);
+    }
+
+    args.states = 2;
+    cells_t cells(args.height, args.width);
+    cells[30][29] = cells[30][30] = cells[30][31] = 1;
+    auto blinker = Board(args, cells);
+    blinker.update();
+    blinker.trackCycles(true);
+    REQUIRE(blinker.getCycleReport().evolution == Evolution::RUNNING);
+    blinker.update();
+    REQUIRE(blinker.getCycleReport().evolution == Evolution::RUNNING);
+    blinker.update();
+    REQUIRE(blinker.getCycleReport().evolution == Evolution::PERIODIC);
+    REQUIRE(blinker.getCycleReport().period == 2);
+    REQUIRE(blinker.getCycleReport().generation == 3);
+
+    blinker.trackCycles(false);
+    REQUIRE(blinker.getCycleReport().evolution == Evolution::RUNNING);
+}
+
+TEST_CASE("Cycles match repetitions of the cells")
+{
+    BoardArgs args;
+    args.width = 300;
+    args.height = 40;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    for (int states : {2, 3}) {
+        for (bool isWrapped : {false, true}) {
+            for (bool isStepped : {false, true}) {
+                args.states = states;
+                args.isWrappedHorizontally = args.isWrappedVertically = isWrapped;
+                // a few patches of Life settle in a few hundred generations
+                auto board = Board(args, sparseCells(args.height, args.width, 8, (unsigned) states));
+                board.trackCycles(true);
+                std::vector<cells_t> history = {board.getCells()};
+                size_t period = 0;
+                while (period == 0 && history.size() < 1000) {
+                    if (isStepped)
+                        board.step(1);
+                    else
+                        board.update();
+                    for (size_t index = 0; index < history.size() && period == 0; ++index)
+                        if (equalCells(history[index], board.getCells()))
+                            period = history.size() - index;
+                    REQUIRE((board.getCycleReport().evolution == Evolution::RUNNING) == (period == 0));
+                    history.push_back(board.getCells());
+                }
+                REQUIRE(period != 0);
+                REQUIRE(board.getCycleReport().period == period);
+                REQUIRE(board.getCycleReport().generation == history.size() - 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("Restored boards keep their states and generation")
+{
+    BoardArgs args;
+    args.states = 4;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    cells_t expected = randomCells(args.height, args.width, 0.3, 31);
+    for (size_t row = 0; row < args.height; row += 3)
+        for (size_t col = 0; col < args.width; col += 5)
+            expected[row][col] = (cell_t) (2 + (row + col) % 2);
+    REQUIRE_THROWS_AS(Board(args, expected), std::invalid_argument);
+
+    auto board = Board(args, expected, 42);
+    REQUIRE(board.getGeneration() == 42);
+    REQUIRE(equalCells(board.getCells(), expected));
+    for (int generation = 0; generation < 5; ++generation) {
+        board.update();
+        referenceUpdate(args, expected);
+        REQUIRE(equalCells(board.getCells(), expected));
+    }
+    REQUIRE(board.getGeneration() == 47);
+
+    expected[0][0] = 4;
+    REQUIRE_THROWS_AS(Board(args, expected, 0), std::invalid_argument);
+}
+
+TEST_CASE("Boards with few changes match the naive update")
+{
+    BoardArgs args;
+    args.width = 300;
+    args.height = 200;
+    for (int states : {2, 3}) {
+        for (int radius : {1, 5}) {
+            args.states = states;
+            args.neighborhoodRadius = radius;
+            args.isIncludeCenter = radius > 1;
+            // Life, and Bosco's rule, which keep small patterns alive
+            args.birthConds = radius > 1 ? conds_t{34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45} : conds_t{3};
+            args.surviveConds.clear();
+            for (int count = (radius > 1 ? 34 : 2); count <= (radius > 1 ? 58 : 3); ++count)
+                args.surviveConds.insert(count);
+
+            cells_t expected = sparseCells(args.height, args.width, 12, (unsigned) (states + radius));
+            auto board = Board(args, expected);
+            board.recordChanges(true);
+            cells_t last = expected;
+            for (int generation = 0; generation < 40; ++generation) {
+                board.update();
+                referenceUpdate(args, expected);
+                REQUIRE(equalCells(board.getCells(), expected));
+                requireChangesLeadTo(board, last);
+            }
+            board.step(10);
+            for (int generation = 0; generation < 10; ++generation)
+                referenceUpdate(args, expected);
+            REQUIRE(equalCells(board.getCells(), expected));
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#include <catch2/catch_all.hpp>
+#include <string>
+#include <fstream>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../src/checkpoint.hpp"
+#include "helpers.hpp"
+
+
+/* Returns a checkpoint path unique to this process. */
+std::string getCheckpointPath(const std::string &suffix) {
+    return "/tmp/ltl-test-" + std::to_string(getpid()) + "-" + suffix + ".ltl";
+}
+
+/* Returns the count of bytes of a file. */
+size_t getFileSize(const std::string &path) {
+    struct stat status{};
+    REQUIRE(stat(path.c_str(), &status) == 0);
+    return (size_t) status.st_size;
+}
+
+/* Checks that both boards have the same arguments, generation and cells. */
+void requireSameBoards(const Board &first, const Board &second) {
+    const BoardArgs &firstArgs = first.getArgs(), &secondArgs = second.getArgs();
+    REQUIRE(firstArgs.neighborhoodRadius == secondArgs.neighborhoodRadius);
+    REQUIRE(firstArgs.states == secondArgs.states);
+    REQUIRE(firstArgs.surviveConds == secondArgs.surviveConds);
+    REQUIRE(firstArgs.birthConds == secondArgs.birthConds);
+    REQUIRE(firstArgs.isIncludeCenter == secondArgs.isIncludeCenter);
+    REQUIRE(firstArgs.neighborhoodType == secondArgs.neighborhoodType);
+    REQUIRE(firstArgs.neighborhoodWeights == secondArgs.neighborhoodWeights);
+    REQUIRE(firstArgs.width == secondArgs.width);
+    REQUIRE(firstArgs.height == secondArgs.height);
+    REQUIRE(firstArgs.threads == secondArgs.threads);
+    REQUIRE(firstArgs.isWrappedHorizontally == secondArgs.isWrappedHorizontally);
+    REQUIRE(firstArgs.isWrappedVertically == secondArgs.isWrappedVertically);
+    REQUIRE(first.getGeneration() == second.getGeneration());
+    REQUIRE(equalCells(first.getCells(), second.getCells()));
+}
+
+TEST_CASE("Checkpoints restore rules, generation and cells")
+{
+    BoardArgs args;
+    args.width = 150;
+    args.height = 90;
+    args.neighborhoodRadius = 2;
+    args.states = 5;
+    args.neighborhoodType = NeighborhoodType::VON_NEUMANN;
+    args.isIncludeCenter = true;
+    args.birthConds = {3, 4, 9};
+    args.surviveConds = {2, 3, 4, 5};
+    args.threads = 2;
+    args.isWrappedHorizontally = true;
+
+    auto board = Board(args, randomCells(args.height, args.width, 0.4, 5));
+    for (int generation = 0; generation < 7; ++generation)
+        board.update();
+
+    const std::string path = getCheckpointPath("restore");
+    saveCheckpoint(board, path);
+    auto restored = loadCheckpoint(path);
+    requireSameBoards(board, restored);
+    REQUIRE(restored.getGeneration() == 7);
+
+    // restored boards go on as the saved ones
+    board.step(5);
+    restored.step(5);
+    requireSameBoards(board, restored);
+
+    // a later checkpoint replaces the earlier one
+    saveCheckpoint(board, path);
+    requireSameBoards(board, loadCheckpoint(path));
+    unlink(path.c_str());
+}
+
+TEST_CASE("Checkpoints of sparse boards are small")
+{
+    BoardArgs args;
+    args.width = 3000;
+    args.height = 2000;
+    args.neighborhoodRadius = 1;
+    args.neighborhoodType = NeighborhoodType::CUSTOM;
+    args.neighborhoodWeights = {1, 2, 1, 2, 0, 2, 1, 2, 1};
+    args.states = 200;
+    args.birthConds = {5};
+    args.surviveConds = {4, 5, 6};
+    cells_t cells(args.height, args.width);
+    cells[0][0] = cells[1000][1500] = cells[1999][2999] = 1;
+    cells[1000][1501] = 199;
+
+    const std::string path = getCheckpointPath("sparse");
+    const auto board = Board(args, cells, 123456789);
+    saveCheckpoint(board, path);
+    REQUIRE(getFileSize(path) < 200);
+    requireSameBoards(board, loadCheckpoint(path));
+    unlink(path.c_str());
+}
+
+TEST_CASE("Loading incorrect checkpoints")
+{
+    REQUIRE_THROWS_AS(loadCheckpoint(getCheckpointPath("missing")), std::system_error);
+
+    BoardArgs args;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    const std::string path = getCheckpointPath("incorrect");
+    saveCheckpoint(Board(args), path);
+    REQUIRE_THROWS_AS(saveCheckpoint(Board(args), "/nonexistent/board.ltl"), std::system_error);
+
+    std::string bytes;
+    {
+        std::ifstream file(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    const auto requireIncorrect = [&path](const std::string &content) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+        REQUIRE_THROWS_AS(loadCheckpoint(path), std::invalid_argument);
+    };
+
+    requireIncorrect("");
+    requireIncorrect(std::string(100, 'x'));
+    requireIncorrect(bytes.substr(0, bytes.size() - 1));
+    requireIncorrect(bytes + '\0');
+
+    std::string changed = bytes;
+    changed[8] = 2;    // version
+    requireIncorrect(changed);
+    changed = bytes;
+    changed[24] = 100;  // neighborhood type
+    requireIncorrect(changed);
+    changed = bytes;
+    changed[bytes.size() - 1] = 7;  // state of the last run, above the state count
+    requireIncorrect(changed);
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+    REQUIRE(loadCheckpoint(path).getCells().getWidth() == args.width);
+    unlink(path.c_str());
+}
@@ -0,0 +1,116 @@
+#include <catch2/catch_all.hpp>
+#include <vector>
+#include "../src/counting.hpp"
+#include "helpers.hpp"
+
+
+/* Checks that an engine counts exactly as many state 1
+ * cells as the cell by cell scan does, for every cell.
+ * Aging cells of the other states must not be counted. */
+void requireSameAsRowScan(NeighborCounter &counter, const BoardArgs &args, const cells_t &cells) {
+    mask_t alive;
+    fillAliveMask(cells, alive);
+
+    RowScanCounter reference(args);
+    reference.prepare(alive, cells.getWidth());
+    counter.prepare(alive, cells.getWidth());
+
+    std::vector<count_t> expected(cells.getWidth()), actual(cells.getWidth());
+    for (size_t row = 0; row < cells.getHeight(); ++row) {
+        reference.countRow(row, expected.data());
+        counter.countRow(row, actual.data());
+        REQUIRE(actual == expected);
+    }
+}
+
+TEST_CASE("BoxSumCounter counts like RowScanCounter")
+{
+    BoardArgs args;
+    args.neighborhoodType = NeighborhoodType::MOORE;
+    for (int radius : {1, 3, 8, 30}) {
+        args.neighborhoodRadius = radius;
+        BoxSumCounter counter(args);
+        requireSameAsRowScan(counter, args, randomStateCells(23, 34, 3, 0.4, (unsigned) radius));
+        requireSameAsRowScan(counter, args, randomStateCells(20, 131, 3, 0.4, (unsigned) radius));
+    }
+}
+
+TEST_CASE("DiamondCounter counts like RowScanCounter")
+{
+    BoardArgs args;
+    args.neighborhoodType = NeighborhoodType::VON_NEUMANN;
+    for (int radius : {1, 2, 5, 11, 40}) {
+        args.neighborhoodRadius = radius;
+        DiamondCounter counter(args);
+        requireSameAsRowScan(counter, args, randomStateCells(31, 19, 3, 0.4, (unsigned) radius));
+        requireSameAsRowScan(counter, args, randomStateCells(27, 133, 3, 0.4, (unsigned) radius));
+        requireSameAsRowScan(counter, args, randomStateCells(1, 45, 3, 0.5, (unsigned) radius));
+        requireSameAsRowScan(counter, args, randomStateCells(45, 1, 3, 0.5, (unsigned) radius));
+    }
+}
+
+TEST_CASE("SpanCounter counts like RowScanCounter")
+{
+    BoardArgs args;
+    for (NeighborhoodType type : {NeighborhoodType::MOORE, NeighborhoodType::VON_NEUMANN,
+                                  NeighborhoodType::CIRCULAR, NeighborhoodType::CHECKERBOARD,
+                                  NeighborhoodType::CROSS, NeighborhoodType::HASH, NeighborhoodType::CUSTOM}) {
+        for (int radius : {1, 2, 5, 17}) {
+            args.neighborhoodType = type;
+            args.neighborhoodRadius = radius;
+            args.neighborhoodWeights.clear();
+            for (int i = 0; i < (2 * radius + 1) * (2 * radius + 1); ++i)
+                args.neighborhoodWeights.push_back(i * 7 % 5);
+            SpanCounter counter(args);
+            requireSameAsRowScan(counter, args, randomStateCells(26, 41, 3, 0.4, (unsigned) radius));
+            requireSameAsRowScan(counter, args, randomStateCells(9, 140, 3, 0.4, (unsigned) radius));
+            requireSameAsRowScan(counter, args, randomStateCells(40, 1, 3, 0.5, (unsigned) radius));
+        }
+    }
+}
+
+TEST_CASE("SpanCounter builds its sums in bands of rows")
+{
+    BoardArgs args;
+    args.neighborhoodType = NeighborhoodType::CHECKERBOARD;
+    args.neighborhoodRadius = 3;
+    ThreadPool pool(3);
+    SpanCounter counter(args, &pool);
+    for (size_t size : {29, 12, 29})
+        requireSameAsRowScan(counter, args, randomStateCells(size, size + 40, 3, 0.4, (unsigned) size));
+}
+
+TEST_CASE("Counters reuse their buffers for boards of other sizes")
+{
+    BoardArgs args;
+    args.neighborhoodRadius = 2;
+    BoxSumCounter boxCounter(args);
+    DiamondCounter diamondCounter(args);
+    for (size_t size : {10, 17, 10}) {
+        auto cells = randomStateCells(size, size + 3, 3, 0.3, (unsigned) size);
+        requireSameAsRowScan(boxCounter, args, cells);
+        args.neighborhoodType = NeighborhoodType::VON_NEUMANN;
+        requireSameAsRowScan(diamondCounter, args, cells);
+        args.neighborhoodType = NeighborhoodType::MOORE;
+    }
+}
+
+TEST_CASE("Counters build their sums in bands of rows")
+{
+    BoardArgs args;
+    for (size_t threads : {2, 3, 7}) {
+        ThreadPool pool(threads);
+        for (int radius : {1, 4}) {
+            args.neighborhoodRadius = radius;
+            args.neighborhoodType = NeighborhoodType::MOORE;
+            BoxSumCounter boxCounter(args, &pool);
+            requireSameAsRowScan(boxCounter, args, randomStateCells(29, 70, 3, 0.4, (unsigned) threads));
+            requireSameAsRowScan(boxCounter, args, randomStateCells(2, 70, 3, 0.4, (unsigned) threads));
+
+            args.neighborhoodType = NeighborhoodType::VON_NEUMANN;
+            DiamondCounter diamondCounter(args, &pool);
+            requireSameAsRowScan(diamondCounter, args, randomStateCells(29, 70, 3, 0.4, (unsigned) threads));
+            requireSameAsRowScan(diamondCounter, args, randomStateCells(2, 70, 3, 0.4, (unsigned) threads));
+        }
+    }
+}
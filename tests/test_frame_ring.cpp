@@ -0,0 +1,83 @@
+#include <catch2/catch_all.hpp>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <algorithm>
+#include <unistd.h>
+#include "../src/frame_ring.hpp"
+
+
+/* Returns a shared memory name unique to this process. */
+std::string getRingName(const std::string &suffix) {
+    return "/ltl-test-" + std::to_string(getpid()) + "-" + suffix;
+}
+
+/* Returns cells of given dimensions, all in the same state. */
+cells_t filledCells(size_t height, size_t width, cell_t state) {
+    cells_t cells(height, width);
+    for (size_t row = 0; row < height; ++row)
+        std::fill(cells[row], cells[row] + width, state);
+    return cells;
+}
+
+TEST_CASE("Create FrameRing with incorrect arguments")
+{
+    REQUIRE_THROWS_AS(FrameRing(getRingName("empty"), 0, 10), std::invalid_argument);
+    REQUIRE_THROWS_AS(FrameRing(getRingName("slots"), 10, 10, 1), std::invalid_argument);
+    REQUIRE_THROWS_AS(FrameRing(getRingName("missing")), std::system_error);
+}
+
+TEST_CASE("Readers get the latest published frame")
+{
+    const std::string name = getRingName("latest");
+    FrameRing writer(name, 7, 90);
+    FrameRing reader(name);
+    REQUIRE(reader.getHeight() == 7);
+    REQUIRE(reader.getWidth() == 90);
+
+    cells_t frame;
+    REQUIRE(reader.readLatest(frame) == 0);
+    REQUIRE_THROWS_AS(writer.publish(filledCells(7, 91, 1)), std::invalid_argument);
+
+    for (cell_t state = 1; state <= 10; ++state)
+        REQUIRE(writer.publish(filledCells(7, 90, state)) == state);
+    REQUIRE(reader.getLatestSequence() == 10);
+    REQUIRE(reader.readLatest(frame) == 10);
+    REQUIRE(frame.getHeight() == 7);
+    REQUIRE(frame.getWidth() == 90);
+    for (size_t row = 0; row < 7; ++row)
+        for (size_t col = 0; col < 90; ++col)
+            REQUIRE(frame[row][col] == 10);
+
+    // frames are published by any process with the ring open
+    reader.publish(filledCells(7, 90, 11));
+    REQUIRE(writer.readLatest(frame) == 11);
+}
+
+TEST_CASE("Frames read while others are published are never torn")
+{
+    const std::string name = getRingName("torn");
+    FrameRing writer(name, 64, 200);
+    FrameRing reader(name);
+    std::atomic<bool> isDone{false};
+
+    std::thread publisher([&] {
+        for (int number = 1; number <= 2000; ++number)
+            writer.publish(filledCells(64, 200, (cell_t) number));
+        isDone = true;
+    });
+
+    cells_t frame;
+    std::uint64_t lastNumber = 0;
+    while (!isDone) {
+        const std::uint64_t number = reader.readLatest(frame);
+        REQUIRE(number >= lastNumber);
+        lastNumber = number;
+        if (number == 0) continue;
+        for (size_t row = 0; row < 64; ++row)
+            for (size_t col = 0; col < 200; ++col)
+                REQUIRE(frame[row][col] == (cell_t) number);
+    }
+    publisher.join();
+    REQUIRE(reader.readLatest(frame) == 2000);
+}
@@ -0,0 +1,150 @@
+#include <catch2/catch_all.hpp>
+#include "../src/incremental.hpp"
+#include "harness.hpp"
+
+
+/* Advances a dead board with a random patch in its middle with
+ * the incremental engine alone, and checks that it matches full
+ * updates of the board after every generation. */
+void requireSameAsFullUpdate(const BoardArgs &args, size_t patchSize, int generations, unsigned seed) {
+    cells_t start(args.height, args.width);
+    placeCells(randomCells(patchSize, patchSize, 0.4, seed), start,
+               (args.height - patchSize) / 2, (args.width - patchSize) / 2);
+    const RuleTable rules(args);
+    IncrementalStepper stepper(args);
+
+    cells_t cells = start, nextCells = start;
+    mask_t alive, nextAlive;
+    fillAliveMask(cells, alive);
+    fillAliveMask(cells, nextAlive);
+    stepper.reset(alive, args.width);
+    REQUIRE(stepper.isReady());
+    REQUIRE(stepper.getCandidateCount() == 0);
+
+    // as if the cells had been dead in the last generation
+    for (size_t row = 0; row < args.height; ++row)
+        for (size_t col = 0; col < args.width; ++col)
+            stepper.addChange(row, col, cells[row][col] == 1);
+    stepper.addChange(0, 0, true);
+
+    requireSameAsUpdates(args, start, generations, 1, [&] {
+        stepper.step(rules, cells, alive, nextCells, nextAlive);
+        std::swap(cells, nextCells);
+        std::swap(alive, nextAlive);
+        stepper.writeChanges(nextCells, nextAlive);
+
+        // cells are left out when rules are advanced on the alive mask only
+        if (args.states == 2)
+            return maskCells(alive, args.width);
+        mask_t expected;
+        fillAliveMask(cells, expected);
+        REQUIRE(equalGrids(alive, expected));
+        return cells;
+    });
+}
+
+TEST_CASE("Incremental counts match full updates with Moore neighborhood")
+{
+    BoardArgs args;
+    args.width = 150;
+    args.height = 90;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    requireSameAsFullUpdate(args, 30, 20, 1);
+
+    args.neighborhoodRadius = 12;
+    args.states = 3;
+    args.isIncludeCenter = true;
+    args.surviveConds = {100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110};
+    args.birthConds = {90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100};
+    requireSameAsFullUpdate(args, 40, 10, 2);
+}
+
+TEST_CASE("Incremental counts match full updates with von Neumann neighborhood")
+{
+    BoardArgs args;
+    args.width = 120;
+    args.height = 100;
+    args.neighborhoodType = NeighborhoodType::VON_NEUMANN;
+    args.neighborhoodRadius = 4;
+    args.states = 4;
+    args.birthConds = {9, 10, 11};
+    args.surviveConds = {8, 9, 10, 11, 12, 13};
+    requireSameAsFullUpdate(args, 30, 15, 3);
+}
+
+TEST_CASE("Incremental counts match full updates with extended neighborhoods")
+{
+    BoardArgs args;
+    args.width = 110;
+    args.height = 80;
+    args.neighborhoodRadius = 3;
+    args.states = 3;
+    for (NeighborhoodType type : {NeighborhoodType::CIRCULAR, NeighborhoodType::CHECKERBOARD,
+                                  NeighborhoodType::HASH, NeighborhoodType::CUSTOM}) {
+        args.neighborhoodType = type;
+        // weights without symmetry, so footprints have to be mirrored
+        args.neighborhoodWeights.clear();
+        for (int i = 0; i < 49; ++i)
+            args.neighborhoodWeights.push_back(i % 3 == 0 ? 2 : i % 5 == 0);
+        const int area = (int) getNeighborhoodSize(args);
+        args.birthConds = {area / 4, area / 4 + 1, area / 3};
+        args.surviveConds = {area / 5, area / 4, area / 4 + 1, area / 3};
+        requireSameAsFullUpdate(args, 25, 12, (unsigned) type);
+    }
+}
+
+TEST_CASE("Incremental steps visit changed cells only")
+{
+    BoardArgs args;
+    args.width = 100;
+    args.height = 100;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    cells_t cells(args.height, args.width);
+    // a blinker flips 4 cells every generation
+    cells[50][49] = cells[50][50] = cells[50][51] = 1;
+    cells_t nextCells = cells;
+    mask_t alive, nextAlive;
+    fillAliveMask(cells, alive);
+    fillAliveMask(cells, nextAlive);
+
+    const RuleTable rules(args);
+    IncrementalStepper stepper(args);
+    stepper.reset(alive, args.width);
+    for (size_t col = 49; col <= 51; ++col)
+        stepper.addChange(50, col, true);
+    REQUIRE(stepper.getCandidateCount() == 3 * 5);
+    for (int generation = 0; generation < 4; ++generation) {
+        stepper.step(rules, cells, alive, nextCells, nextAlive);
+        std::swap(alive, nextAlive);
+        stepper.writeChanges(nextCells, nextAlive);
+        REQUIRE(stepper.getChanges().size() == 4);
+        REQUIRE(stepper.getFlipCount() == 4);
+        REQUIRE(stepper.getCandidateCount() <= 4 * 9);
+    }
+    REQUIRE(isMaskBitSet(alive[50], 49));
+    REQUIRE(!isMaskBitSet(alive[49], 50));
+
+    stepper.invalidate();
+    REQUIRE(!stepper.isReady());
+}
+
+TEST_CASE("Setting up incremental updates records no changes unless enabled")
+{
+    BoardArgs args;
+    args.width = 200;
+    args.height = 200;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    cells_t cells(args.height, args.width);
+    cells[100][99] = cells[100][100] = cells[100][101] = 1;
+    auto board = Board(args, cells);
+    for (int generation = 0; generation < 10; ++generation) {
+        board.update();
+        REQUIRE(board.getChanges().empty());
+    }
+    board.recordChanges(true);
+    board.update();
+    REQUIRE(board.getChanges().size() == 4);
+}
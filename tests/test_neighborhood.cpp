@@ -0,0 +1,88 @@
+#include <catch2/catch_all.hpp>
+#include <vector>
+#include "../src/neighborhood.hpp"
+
+
+/* Checks that the spans of a shape cover every cell of the
+ * neighborhood exactly with its weight, and nothing else. */
+void requireSpansCoverWeights(const NeighborhoodShape &shape) {
+    const int radius = shape.getRadius();
+    const int side = 2 * radius + 1;
+    std::vector<count_t> covered((size_t) (side * side), 0);
+    for (const NeighborhoodSpan &span : shape.getSpans()) {
+        REQUIRE((span.step == 1 || span.step == 2));
+        REQUIRE(span.firstCol <= span.lastCol);
+        REQUIRE((span.lastCol - span.firstCol) % span.step == 0);
+        for (int col = span.firstCol; col <= span.lastCol; col += span.step)
+            covered[(size_t) ((span.rowOffset + radius) * side + col + radius)] += span.weight;
+    }
+    for (int row = -radius; row <= radius; ++row)
+        for (int col = -radius; col <= radius; ++col)
+            REQUIRE(covered[(size_t) ((row + radius) * side + col + radius)] == shape.getWeight(row, col));
+}
+
+TEST_CASE("Spans of every shape cover their weights")
+{
+    BoardArgs args;
+    for (NeighborhoodType type : {NeighborhoodType::MOORE, NeighborhoodType::VON_NEUMANN,
+                                  NeighborhoodType::CIRCULAR, NeighborhoodType::CHECKERBOARD,
+                                  NeighborhoodType::CROSS, NeighborhoodType::HASH, NeighborhoodType::CUSTOM}) {
+        for (int radius : {0, 1, 4, 9}) {
+            args.neighborhoodType = type;
+            args.neighborhoodRadius = radius;
+            args.neighborhoodWeights.clear();
+            for (int i = 0; i < (2 * radius + 1) * (2 * radius + 1); ++i)
+                args.neighborhoodWeights.push_back(i % 4 == 1 ? 0 : i % 3);
+            requireSpansCoverWeights(NeighborhoodShape(args));
+        }
+    }
+}
+
+TEST_CASE("Center of a shape always counts once")
+{
+    BoardArgs args;
+    args.neighborhoodRadius = 1;
+    args.neighborhoodType = NeighborhoodType::CHECKERBOARD;
+    REQUIRE(NeighborhoodShape(args).getWeight(0, 0) == 1);
+    REQUIRE(NeighborhoodShape(args).getSize() == 4);
+
+    args.neighborhoodType = NeighborhoodType::CUSTOM;
+    args.neighborhoodWeights = {1, 2, 1, 2, 7, 2, 1, 2, 1};
+    REQUIRE(NeighborhoodShape(args).getWeight(0, 0) == 1);
+    REQUIRE(NeighborhoodShape(args).getWeight(-1, 0) == 2);
+    REQUIRE(NeighborhoodShape(args).getSize() == 12);
+}
+
+TEST_CASE("Rows of convex shapes are single spans")
+{
+    BoardArgs args;
+    args.neighborhoodRadius = 6;
+    for (NeighborhoodType type : {NeighborhoodType::MOORE, NeighborhoodType::VON_NEUMANN, NeighborhoodType::CIRCULAR}) {
+        args.neighborhoodType = type;
+        NeighborhoodShape shape(args);
+        REQUIRE(shape.getSpans().size() == 13);
+        REQUIRE(!shape.hasSteppedSpans());
+    }
+}
+
+TEST_CASE("Rows of checkerboards are stepped spans")
+{
+    BoardArgs args;
+    args.neighborhoodRadius = 5;
+    args.neighborhoodType = NeighborhoodType::CHECKERBOARD;
+    NeighborhoodShape shape(args);
+    REQUIRE(shape.hasSteppedSpans());
+    // the center adds a span to its row
+    REQUIRE(shape.getSpans().size() == 12);
+}
+
+TEST_CASE("Shapes with wrong custom weights are rejected")
+{
+    BoardArgs args;
+    args.neighborhoodRadius = 1;
+    args.neighborhoodType = NeighborhoodType::CUSTOM;
+    args.neighborhoodWeights = {1, 1, 1};
+    REQUIRE_THROWS_AS(NeighborhoodShape(args), std::invalid_argument);
+    args.neighborhoodWeights = {1, 1, 1, 1, 1, 1, 1, 1, -2};
+    REQUIRE_THROWS_AS(NeighborhoodShape(args), std::invalid_argument);
+}
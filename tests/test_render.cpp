@@ -0,0 +1,47 @@
+#include <catch2/catch_all.hpp>
+#include <vector>
+#include "../src/render.hpp"
+
+
+const Rgb DEAD_COLOR = {115, 140, 165};
+const Rgb ALIVE_COLOR = {165, 230, 130};
+const Rgb GAP_COLOR = {0, 0, 0};
+
+bool equalColors(Rgb first, Rgb second) {
+    return first.red == second.red && first.green == second.green && first.blue == second.blue;
+}
+
+TEST_CASE("Create Renderer with incorrect arguments")
+{
+    REQUIRE_THROWS_AS(Renderer(1, 10, 1, DEAD_COLOR, ALIVE_COLOR, GAP_COLOR), std::invalid_argument);
+    REQUIRE_THROWS_AS(Renderer(2, 0, 0, DEAD_COLOR, ALIVE_COLOR, GAP_COLOR), std::invalid_argument);
+    REQUIRE_THROWS_AS(Renderer(2, 4, 2, DEAD_COLOR, ALIVE_COLOR, GAP_COLOR), std::invalid_argument);
+}
+
+TEST_CASE("Older cells fade along a gray ramp")
+{
+    Renderer renderer(5, 10, 1, DEAD_COLOR, ALIVE_COLOR, GAP_COLOR);
+    REQUIRE(equalColors(renderer.getColor(0), DEAD_COLOR));
+    REQUIRE(equalColors(renderer.getColor(1), ALIVE_COLOR));
+    REQUIRE(equalColors(renderer.getColor(2), {204, 204, 204}));
+    REQUIRE(equalColors(renderer.getColor(4), {102, 102, 102}));
+}
+
+TEST_CASE("Cells are drawn as tiles with gaps")
+{
+    const size_t tile = 4, gap = 1, height = 2, width = 3, stride = 8;
+    const cell_t cells[height * stride] = {0, 1, 2, 9, 9, 9, 9, 9,
+                                           2, 0, 1, 9, 9, 9, 9, 9};
+    Renderer renderer(3, tile, gap, DEAD_COLOR, ALIVE_COLOR, GAP_COLOR);
+    std::vector<std::uint8_t> frame(height * tile * width * tile * 3);
+    renderer.render(cells, height, width, stride, frame.data());
+
+    for (size_t y = 0; y < height * tile; ++y) {
+        for (size_t x = 0; x < width * tile; ++x) {
+            const std::uint8_t *pixel = &frame[(y * width * tile + x) * 3];
+            const bool isGap = y % tile < gap || y % tile >= tile - gap || x % tile < gap || x % tile >= tile - gap;
+            const Rgb expected = isGap ? GAP_COLOR : renderer.getColor(cells[y / tile * stride + x / tile]);
+            REQUIRE(equalColors({pixel[0], pixel[1], pixel[2]}, expected));
+        }
+    }
+}
@@ -0,0 +1,180 @@
+#include <catch2/catch_all.hpp>
+#include <string>
+#include <sstream>
+#include "../src/rle.hpp"
+#include "helpers.hpp"
+
+
+/* Checks that the pattern has the rules of 'args' and the given cells. */
+void requireSamePattern(const RlePattern &pattern, const BoardArgs &args, const cells_t &cells) {
+    REQUIRE(pattern.args.neighborhoodRadius == args.neighborhoodRadius);
+    REQUIRE(pattern.args.states == args.states);
+    REQUIRE(pattern.args.surviveConds == args.surviveConds);
+    REQUIRE(pattern.args.birthConds == args.birthConds);
+    REQUIRE(pattern.args.isIncludeCenter == args.isIncludeCenter);
+    REQUIRE(pattern.args.neighborhoodType == args.neighborhoodType);
+    REQUIRE(pattern.args.width == cells.getWidth());
+    REQUIRE(pattern.args.height == cells.getHeight());
+    REQUIRE(pattern.args.isWrappedHorizontally == args.isWrappedHorizontally);
+    REQUIRE(pattern.args.isWrappedVertically == args.isWrappedVertically);
+    REQUIRE(equalCells(pattern.cells, cells));
+}
+
+TEST_CASE("Rules are written in the syntax of Golly")
+{
+    BoardArgs args;
+    args.neighborhoodRadius = 5;
+    args.isIncludeCenter = true;
+    args.surviveConds = {34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58};
+    args.birthConds = {34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45};
+    REQUIRE(getGollyRule(args) == "R5,C2,M1,S34..58,B34..45,NM:P60,60");
+
+    args.neighborhoodRadius = 2;
+    args.states = 3;
+    args.isIncludeCenter = false;
+    args.surviveConds = {1, 2, 3, 6};
+    args.birthConds = {3};
+    args.neighborhoodType = NeighborhoodType::VON_NEUMANN;
+    args.width = 100;
+    args.height = 80;
+    args.isWrappedHorizontally = args.isWrappedVertically = true;
+    REQUIRE(getGollyRule(args) == "R2,C3,S1-3,6,B3,NN:T100,80");
+
+    // a surviving cell counts itself in the middle
+    args.isIncludeCenter = true;
+    args.surviveConds = {0, 2, 3, 5};
+    args.neighborhoodType = NeighborhoodType::HASH;
+    REQUIRE(getGollyRule(args) == "R2,C3,S1-2,4,B3,N#:T100,80");
+
+    args.isWrappedVertically = false;
+    REQUIRE_THROWS_AS(getGollyRule(args), std::invalid_argument);
+    args.isWrappedVertically = true;
+    args.neighborhoodType = NeighborhoodType::CUSTOM;
+    REQUIRE_THROWS_AS(getGollyRule(args), std::invalid_argument);
+}
+
+TEST_CASE("Rules of Golly are parsed")
+{
+    BoardArgs args;
+    args.threads = 3;
+    parseGollyRule("R10,C0,M1,S123..212,B123..170,NM", args);
+    REQUIRE(args.neighborhoodRadius == 10);
+    REQUIRE(args.states == 2);
+    REQUIRE(args.isIncludeCenter);
+    REQUIRE(args.surviveConds.size() == 90);
+    REQUIRE(*args.surviveConds.begin() == 123);
+    REQUIRE(*args.birthConds.rbegin() == 170);
+    REQUIRE(args.neighborhoodType == NeighborhoodType::MOORE);
+    REQUIRE(args.width == BOARD_SIZE);
+    REQUIRE(args.threads == 3);
+
+    parseGollyRule("r2, c3, s1-3,6, b3, n+ :t20,10", args);
+    REQUIRE(args.neighborhoodRadius == 2);
+    REQUIRE(args.states == 3);
+    REQUIRE_FALSE(args.isIncludeCenter);
+    REQUIRE(args.surviveConds == conds_t{1, 2, 3, 6});
+    REQUIRE(args.birthConds == conds_t{3});
+    REQUIRE(args.neighborhoodType == NeighborhoodType::CROSS);
+    REQUIRE(args.width == 20);
+    REQUIRE(args.height == 10);
+    REQUIRE(args.isWrappedHorizontally);
+    REQUIRE(args.isWrappedVertically);
+
+    parseGollyRule("R3,C2,S2,B3,NB:P30", args);
+    REQUIRE(args.neighborhoodType == NeighborhoodType::CHECKERBOARD);
+    REQUIRE(args.width == 30);
+    REQUIRE(args.height == 30);
+    REQUIRE_FALSE(args.isWrappedHorizontally);
+
+    // written rules are parsed back
+    for (const NeighborhoodType type : {NeighborhoodType::CIRCULAR, NeighborhoodType::HASH}) {
+        BoardArgs written;
+        written.states = 7;
+        written.isIncludeCenter = true;
+        written.surviveConds = {3, 4, 8};
+        written.birthConds = {2, 5, 6};
+        written.neighborhoodType = type;
+        BoardArgs parsed;
+        parseGollyRule(getGollyRule(written), parsed);
+        REQUIRE(getGollyRule(parsed) == getGollyRule(written));
+        REQUIRE(parsed.birthConds == written.birthConds);
+    }
+
+    for (const char *rule : {"B3/S23", "R1,C2,S2..3", "R1,C2,M2,S2..3,B3..3,NM", "R1,C2,S3..2,B3,NM",
+                             "R1,C2,S2,B3,N@1f", "R1,C2,S2,B3,NM:K10,10", "R1,C2,S2,B3,NM:T0,10",
+                             "R1,C2,S2,B3,NM:T10+1,10", "R1,,C2,S2,B3,NM", "R1,C2,S2,B3,Q1"})
+        REQUIRE_THROWS_AS(parseGollyRule(rule, args), std::invalid_argument);
+    REQUIRE(args.neighborhoodType == NeighborhoodType::CHECKERBOARD);
+}
+
+TEST_CASE("Patterns written as RLE are read back")
+{
+    for (int states : {2, 3, 256}) {
+        for (bool isWrapped : {false, true}) {
+            BoardArgs args;
+            args.states = states;
+            args.width = 157;
+            args.height = 93;
+            args.birthConds = {3};
+            args.surviveConds = {2, 3};
+            args.isWrappedHorizontally = args.isWrappedVertically = isWrapped;
+            cells_t cells(args.height, args.width);
+            placeCells(randomStateCells(40, 120, states, 0.4, (unsigned) states), cells, 31, 20);
+
+            const std::string text = writeRle(args, cells);
+            std::istringstream lines(text);
+            std::string line;
+            while (std::getline(lines, line))
+                REQUIRE(line.size() <= RLE_LINE_LENGTH);
+            requireSamePattern(readRle(text), args, cells);
+        }
+    }
+
+    BoardArgs args;
+    args.birthConds = {3};
+    args.surviveConds = {2, 3};
+    const cells_t empty(args.height, args.width);
+    const std::string text = writeRle(args, empty);
+    REQUIRE(text.find("x = 0, y = 0") != std::string::npos);
+    requireSamePattern(readRle(text), args, empty);
+}
+
+TEST_CASE("Patterns of Golly are read")
+{
+    // patterns without a rule are Life patterns of their own size
+    const RlePattern glider = readRle("#N Glider\n#C A comment\nx = 3, y = 3\nbo$2b\no$3o!\n");
+    REQUIRE(glider.args.width == 3);
+    REQUIRE(glider.args.height == 3);
+    REQUIRE(glider.args.surviveConds == conds_t{2, 3});
+    REQUIRE(glider.args.birthConds == conds_t{3});
+    REQUIRE(glider.cells[0][1] == 1);
+    REQUIRE(glider.cells[1][2] == 1);
+    REQUIRE(glider.cells[2][0] == 1);
+    REQUIRE(glider.cells[1][0] == 0);
+
+    // patterns are centered on bounded grids without a position
+    const RlePattern centered = readRle("x = 3, y = 2, rule = R2,C4,M0,S1..4,B2..2,NM:T11,8\r\nA.C$2B!\r\n");
+    REQUIRE(centered.args.states == 4);
+    REQUIRE(centered.args.width == 11);
+    REQUIRE(centered.args.height == 8);
+    REQUIRE(centered.cells[3][4] == 1);
+    REQUIRE(centered.cells[3][5] == 0);
+    REQUIRE(centered.cells[3][6] == 3);
+    REQUIRE(centered.cells[4][4] == 2);
+    REQUIRE(centered.cells[4][5] == 2);
+
+    const RlePattern placed = readRle("#CXRLE Pos=-5,-4\nx = 1, y = 1, rule = R1,C3,M0,S2..3,B3..3,NM:P10,8\nyO!");
+    REQUIRE(placed.cells[0][0] == 255);
+    const RlePattern multiState = readRle("x = 4, y = 3, rule = R1,C31,M0,S2..3,B3..3,NM\npA2X$$3.pF!");
+    REQUIRE(multiState.cells[0][0] == 25);
+    REQUIRE(multiState.cells[0][1] == 24);
+    REQUIRE(multiState.cells[0][2] == 24);
+    REQUIRE(multiState.cells[1][0] == 0);
+    REQUIRE(multiState.cells[2][3] == 30);
+
+    for (const char *text : {"bo$2bo$3o!", "x = 3, y = 3\nbo$2bo$4o!", "x = 3, y = 3\nbo$2bo$2bo$o!",
+                             "x = 3, y = 3\nbz!", "x = 3, y = 3, rule = B3/S23\no!",
+                             "x = 3, y = 3, rule = R1,C2,S2,B3,NM:T2,2\no!",
+                             "#CXRLE Pos=4,0\nx = 3, y = 3, rule = R1,C2,S2,B3,NM:T10,10\no!"})
+        REQUIRE_THROWS_AS(readRle(text), std::invalid_argument);
+}
@@ -0,0 +1,95 @@
+#include <catch2/catch_all.hpp>
+#include <random>
+#include <vector>
+#include "../src/simd.hpp"
+
+
+/* Instruction sets of this processor, other than scalar. */
+std::vector<InstructionSet> getVectorInstructionSets() {
+    std::vector<InstructionSet> supported;
+    for (auto instructionSet : {InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512}) {
+        if (isInstructionSetSupported(instructionSet))
+            supported.push_back(instructionSet);
+    }
+    return supported;
+}
+
+std::vector<count_t> randomCounts(size_t length, count_t maxCount, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<count_t> dist(0, maxCount);
+    std::vector<count_t> counts(length);
+    for (auto &count : counts)
+        count = dist(generator);
+    return counts;
+}
+
+TEST_CASE("Scalar kernels are always supported")
+{
+    REQUIRE(isInstructionSetSupported(InstructionSet::Scalar));
+    REQUIRE(getRowKernels(InstructionSet::Scalar).instructionSet == InstructionSet::Scalar);
+    REQUIRE(isInstructionSetSupported(getRowKernels().instructionSet));
+}
+
+TEST_CASE("Vector kernels combine rows like scalar kernels")
+{
+    const RowKernels &scalar = getRowKernels(InstructionSet::Scalar);
+    for (auto instructionSet : getVectorInstructionSets()) {
+        const RowKernels &kernels = getRowKernels(instructionSet);
+        for (size_t length : {0, 3, 16, 61, 200}) {
+            // prefix sums wrap around, so any values have to work
+            auto plus = randomCounts(length, UINT32_MAX, 1);
+            auto minus = randomCounts(length, UINT32_MAX, 2);
+            auto otherMinus = randomCounts(length, UINT32_MAX, 3);
+            auto otherPlus = randomCounts(length, UINT32_MAX, 4);
+            auto expected = randomCounts(length, 1000, 5), actual = expected;
+
+            scalar.combineRows(plus.data(), minus.data(), otherMinus.data(), otherPlus.data(), expected.data(), length);
+            kernels.combineRows(plus.data(), minus.data(), otherMinus.data(), otherPlus.data(), actual.data(), length);
+            REQUIRE(actual == expected);
+
+            scalar.accumulateRows(plus.data(), minus.data(), otherMinus.data(), otherPlus.data(), expected.data(), length);
+            kernels.accumulateRows(plus.data(), minus.data(), otherMinus.data(), otherPlus.data(), actual.data(), length);
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("Vector kernels apply rules like scalar kernels")
+{
+    const RowKernels &scalar = getRowKernels(InstructionSet::Scalar);
+    for (int states : {2, 5, 256}) {
+        BoardArgs args;
+        args.states = states;
+        args.neighborhoodRadius = 2;
+        args.birthConds = {0, 3, 4, 5, 24};
+        args.surviveConds = {2, 3, 7, 8, 9};
+        RuleTable rules(args);
+        const TransitionView view = rules.getView();
+
+        for (size_t width : {1, 63, 64, 150, 300}) {
+            // counts past the largest condition have to be clamped
+            auto counts = randomCounts(width, getNeighborhoodSize(args) + 40, (unsigned) width);
+            std::mt19937 generator((unsigned) states);
+            std::uniform_int_distribution<int> dist(0, states - 1);
+            std::vector<cell_t> cells(width);
+            for (auto &cell : cells)
+                cell = (cell_t) dist(generator);
+
+            const size_t words = getMaskWords(width);
+            std::vector<cell_t> expected(width);
+            std::vector<mask_word_t> expectedMask(words);
+            scalar.transitionRow(view, cells.data(), counts.data(), expected.data(), expectedMask.data(), width);
+            for (size_t col = 0; col < width; ++col)
+                REQUIRE(expected[col] == rules.next(cells[col], counts[col]));
+
+            for (auto instructionSet : getVectorInstructionSets()) {
+                std::vector<cell_t> actual(width);
+                std::vector<mask_word_t> actualMask(words);
+                getRowKernels(instructionSet).transitionRow(view, cells.data(), counts.data(),
+                                                            actual.data(), actualMask.data(), width);
+                REQUIRE(actual == expected);
+                REQUIRE(actualMask == expectedMask);
+            }
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#include <catch2/catch_all.hpp>
+#include "../src/sparse_board.hpp"
+#include "harness.hpp"
+
+
+/* Runs a random patch on a sparse board, at a position crossing
+ * chunk borders and the origin, and on a board large enough for
+ * its edges not to be reached, and checks that both match after
+ * every generation. */
+void requireSameAsBoard(BoardArgs args, size_t patchSize, int generations, unsigned seed) {
+    const cells_t patch = randomCells(patchSize, patchSize, 0.4, seed);
+    const coord_t margin = (coord_t) (generations * args.neighborhoodRadius) + 1;
+    args.width = args.height = patchSize + 2 * (size_t) margin;
+    cells_t start(args.height, args.width);
+    placeCells(patch, start, (size_t) margin, (size_t) margin);
+
+    SparseBoard sparse(args);
+    const coord_t top = -(coord_t) patchSize / 2, left = 61;
+    sparse.setCells(top, left, patch);
+    requireSameAsUpdates(args, start, generations, 1, [&] {
+        sparse.update();
+        return sparse.getRegion(top - margin, left - margin, args.height, args.width);
+    });
+}
+
+TEST_CASE("Create SparseBoard with birth on zero neighbors")
+{
+    BoardArgs args;
+    args.surviveConds = {2, 3};
+    args.birthConds = {0, 3};
+    REQUIRE_THROWS_AS(SparseBoard(args), std::invalid_argument);
+    args.birthConds = {3};
+    args.neighborhoodRadius = NEIGHBORHOOD_RADIUS_MAX + 1;
+    REQUIRE_THROWS_AS(SparseBoard(args), std::invalid_argument);
+}
+
+TEST_CASE("Cells of a sparse board are set anywhere")
+{
+    BoardArgs args;
+    args.states = 3;
+    args.surviveConds = {2, 3};
+    args.birthConds = {3};
+    SparseBoard board(args);
+    REQUIRE(board.getChunkCount() == 0);
+    REQUIRE_THROWS_AS(board.setCell(0, 0, 3), std::invalid_argument);
+
+    board.setCell(-1, -1, 1);
+    board.setCell(1000000000000LL, 5, 2);
+    REQUIRE(board.getCell(-1, -1) == 1);
+    REQUIRE(board.getCell(1000000000000LL, 5) == 2);
+    REQUIRE(board.getCell(0, 0) == 0);
+    REQUIRE(board.getPopulation() == 2);
+    REQUIRE(board.getChunkCount() == 2);
+
+    const BoundingBox box = board.getBoundingBox();
+    REQUIRE(box.top == -1);
+    REQUIRE(box.left == -1);
+    REQUIRE(box.bottom == 1000000000001LL);
+    REQUIRE(box.right == 6);
+
+    board.setCell(-1, -1, 0);
+    REQUIRE(board.getChunkCount() == 1);
+}
+
+TEST_CASE("Sparse board matches a board with Moore neighborhood")
+{
+    BoardArgs args;
+    args.surviveConds = {2, 3};
+    args.birthConds = {3};
+    requireSameAsBoard(args, 40, 20, 1);
+
+    args.neighborhoodRadius = 5;
+    args.states = 4;
+    args.surviveConds = {30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40};
+    args.birthConds = {30, 31, 32, 33, 34, 35, 36};
+    requireSameAsBoard(args, 40, 10, 2);
+
+    // blocks of several chunks
+    args.neighborhoodRadius = 70;
+    args.isIncludeCenter = true;
+    args.surviveConds = {3000, 3001, 3002, 3003, 3004, 3005};
+    args.birthConds = {3000, 3001, 3002};
+    requireSameAsBoard(args, 150, 2, 3);
+}
+
+TEST_CASE("Sparse board matches a board with von Neumann neighborhood")
+{
+    BoardArgs args;
+    args.neighborhoodType = NeighborhoodType::VON_NEUMANN;
+    args.neighborhoodRadius = 3;
+    args.states = 3;
+    args.surviveConds = {5, 6, 7, 8};
+    args.birthConds = {4, 5, 6};
+    args.threads = 3;
+    requireSameAsBoard(args, 40, 10, 4);
+}
+
+TEST_CASE("Gliders travel on a sparse board without edges")
+{
+    BoardArgs args;
+    args.surviveConds = {2, 3};
+    args.birthConds = {3};
+    SparseBoard board(args);
+    const coord_t glider[5][2] = {{0, 1}, {1, 2}, {2, 0}, {2, 1}, {2, 2}};
+    for (const auto &cell : glider)
+        board.setCell(cell[0], cell[1], 1);
+
+    // a glider moves one cell down and right every 4 generations
+    board.step(400);
+    REQUIRE(board.getPopulation() == 5);
+    REQUIRE(board.getChunkCount() <= 4);
+    for (const auto &cell : glider)
+        REQUIRE(board.getCell(cell[0] + 100, cell[1] + 100) == 1);
+
+    const BoundingBox box = board.getBoundingBox();
+    REQUIRE(box.top == 100);
+    REQUIRE(box.left == 100);
+    REQUIRE(box.bottom == 103);
+    REQUIRE(box.right == 103);
+}
+
+TEST_CASE("Empty chunks of a sparse board are freed")
+{
+    BoardArgs args;
+    args.surviveConds = {2, 3};
+    args.birthConds = {3};
+    SparseBoard board(args);
+    board.setCell(-70, 500, 1);
+    board.setCell(63, 63, 1);
+    board.update();
+    REQUIRE(board.getChunkCount() == 0);
+    REQUIRE(board.getPopulation() == 0);
+}
@@ -0,0 +1,64 @@
+#include <catch2/catch_all.hpp>
+#include <atomic>
+#include <vector>
+#include "../src/thread_pool.hpp"
+
+
+TEST_CASE("ThreadPool runs every task exactly once")
+{
+    for (size_t threads : {1, 2, 5}) {
+        ThreadPool pool(threads);
+        REQUIRE(pool.getThreadCount() == threads);
+        for (size_t count : {0, 1, 3, 100}) {
+            std::vector<std::atomic<int>> calls(count);
+            pool.run(count, [&](size_t index) { ++calls[index]; });
+            for (const auto &callCount : calls)
+                REQUIRE(callCount == 1);
+        }
+    }
+}
+
+TEST_CASE("ThreadPool keeps its threads for many batches")
+{
+    ThreadPool pool(4);
+    std::atomic<size_t> sum{0};
+    for (size_t batch = 0; batch < 500; ++batch)
+        pool.run(8, [&](size_t index) { sum += index; });
+    REQUIRE(sum == 500 * 28);
+}
+
+TEST_CASE("forEachBand covers all rows with adjacent bands")
+{
+    for (size_t threads : {1, 3, 8}) {
+        ThreadPool pool(threads);
+        for (size_t rows : {1, 2, 7, 64}) {
+            const size_t bands = getBandCount(&pool, rows);
+            REQUIRE(bands == std::min(threads, rows));
+
+            std::vector<size_t> firsts(bands), lasts(bands);
+            forEachBand(&pool, rows, [&](size_t band, size_t first, size_t last) {
+                firsts[band] = first;
+                lasts[band] = last;
+            });
+            REQUIRE(firsts.front() == 0);
+            REQUIRE(lasts.back() == rows);
+            for (size_t band = 0; band < bands; ++band) {
+                REQUIRE(firsts[band] < lasts[band]);
+                if (band > 0)
+                    REQUIRE(firsts[band] == lasts[band - 1]);
+            }
+        }
+    }
+}
+
+TEST_CASE("forEachBand without a pool runs a single band")
+{
+    size_t calls = 0;
+    forEachBand(nullptr, 10, [&](size_t band, size_t first, size_t last) {
+        REQUIRE(band == 0);
+        REQUIRE(first == 0);
+        REQUIRE(last == 10);
+        ++calls;
+    });
+    REQUIRE(calls == 1);
+}